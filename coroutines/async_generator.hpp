@@ -0,0 +1,137 @@
+#ifndef ASYNC_GENERATOR_HPP
+#define ASYNC_GENERATOR_HPP
+
+#include "frame_allocator.hpp"
+
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// generator that may co_await between yields (e.g. a Task or ThreadPoolScheduler::schedule())
+//  * co_await gen.next() resumes the producer & returns its next item - std::nullopt when it has finished
+//  * the producer runs only when the consumer asks for an item - it is suspended at co_yield until the next call of next()
+//  * the consumer is resumed on the thread that produced the item
+template <typename T>
+class [[nodiscard]] AsyncGenerator
+{
+public:
+    struct promise_type;
+
+    using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+    struct promise_type : PooledFrame
+    {
+        AsyncGenerator get_return_object() noexcept
+        {
+            return AsyncGenerator{CoroutineHandle::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        // producer gives control back to the consumer waiting in next()
+        struct ResumeConsumer
+        {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(CoroutineHandle coroutine) noexcept
+            {
+                return coroutine.promise().consumer_;
+            }
+
+            void await_resume() const noexcept { }
+        };
+
+        ResumeConsumer final_suspend() noexcept { return {}; }
+
+        template <typename TValue = T>
+            requires std::constructible_from<T, TValue&&>
+        ResumeConsumer yield_value(TValue&& value) noexcept(std::is_nothrow_constructible_v<T, TValue&&>)
+        {
+            value_.emplace(std::forward<TValue>(value));
+            return {};
+        }
+
+        void return_void() noexcept { }
+
+        void unhandled_exception() noexcept
+        {
+            exception_ = std::current_exception();
+        }
+
+    private:
+        friend class AsyncGenerator;
+
+        std::optional<T> value_;
+        std::exception_ptr exception_;
+        std::coroutine_handle<> consumer_ = std::noop_coroutine();
+    };
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    AsyncGenerator(AsyncGenerator&& other) noexcept
+        : coroutine_{std::exchange(other.coroutine_, nullptr)}
+    { }
+
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (coroutine_)
+                coroutine_.destroy();
+            coroutine_ = std::exchange(other.coroutine_, nullptr);
+        }
+
+        return *this;
+    }
+
+    // the producer must be suspended - not running on another thread
+    ~AsyncGenerator()
+    {
+        if (coroutine_)
+            coroutine_.destroy();
+    }
+
+    // co_await gen.next() - the next item or std::nullopt; rethrows an exception of the producer
+    auto next() noexcept
+    {
+        struct NextAwaiter
+        {
+            CoroutineHandle coroutine;
+
+            bool await_ready() const noexcept { return coroutine.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+            {
+                promise_type& promise = coroutine.promise();
+                promise.consumer_ = consumer;
+                return coroutine; // symmetric transfer - resumes the producer
+            }
+
+            std::optional<T> await_resume()
+            {
+                promise_type& promise = coroutine.promise();
+                if (promise.exception_)
+                    std::rethrow_exception(std::exchange(promise.exception_, nullptr));
+
+                return std::exchange(promise.value_, std::nullopt);
+            }
+        };
+
+        assert(coroutine_);
+        return NextAwaiter{coroutine_};
+    }
+
+private:
+    CoroutineHandle coroutine_ = nullptr;
+
+    explicit AsyncGenerator(CoroutineHandle coroutine) noexcept
+        : coroutine_{coroutine}
+    { }
+};
+
+#endif // ASYNC_GENERATOR_HPP
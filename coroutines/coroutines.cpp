@@ -1,11 +1,32 @@
+#include "async_generator.hpp"
+#include "frame_allocator.hpp"
+#include "generator.hpp"
+#include "io_event_loop.hpp"
+#include "task.hpp"
+#include "thread_pool_scheduler.hpp"
+
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <iostream>
+#include <latch>
+#include <memory_resource>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <coroutine>
 #include <thread>
 #include <syncstream>
 #include <ranges>
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/socket.h>
+#endif
 
 using namespace std::literals;
 
@@ -35,7 +56,7 @@ namespace Step_1
 
         using CoroutineHandle = std::coroutine_handle<promise_type>;
 
-        struct promise_type
+        struct promise_type : PooledFrame
         {
             TaskResumer get_return_object()
             {
@@ -123,7 +144,7 @@ inline auto sync_out(std::ostream& out = std::cout)
 
 struct FireAndForget
 {
-    struct promise_type
+    struct promise_type : PooledFrame
     {
         FireAndForget get_return_object()
         {
@@ -199,9 +220,264 @@ TEST_CASE("resume part of the function on the new thread")
     std::this_thread::sleep_for(5s);
 }
 
-namespace FutureStd
+// fire & forget without logging - for many coroutines
+struct Detached
+{
+    struct promise_type : PooledFrame
+    {
+        Detached get_return_object() noexcept { return {}; }
+
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+
+        std::suspend_never final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception() { std::terminate(); }
+
+        void return_void() const noexcept { }
+    };
+};
+
+Detached coro_on_thread_pool(ThreadPoolScheduler& scheduler, std::atomic<int>& switched_count, std::latch& done)
+{
+    const auto start_thread_id = std::this_thread::get_id();
+
+    co_await scheduler.schedule(); // context switch
+
+    if (std::this_thread::get_id() != start_thread_id)
+        ++switched_count;
+
+    co_await scheduler.schedule(); // stays on the pool - pushed to the deque of the current worker
+
+    done.count_down();
+}
+
+TEST_CASE("resume coroutines on the thread pool")
+{
+    const int coro_count = 1'000;
+
+    std::atomic<int> switched_count{0};
+    std::latch done{coro_count};
+
+    {
+        ThreadPoolScheduler scheduler{4};
+
+        for (int i = 0; i < coro_count; ++i)
+            coro_on_thread_pool(scheduler, switched_count, done);
+
+        done.wait();
+    }
+
+    CHECK(switched_count == coro_count);
+}
+
+Detached switch_on_new_thread(std::latch& done)
+{
+    co_await resume_on_new_thread();
+    done.count_down();
+}
+
+Detached switch_on_thread_pool(ThreadPoolScheduler& scheduler, std::latch& done)
+{
+    co_await scheduler.schedule();
+    done.count_down();
+}
+
+TEST_CASE("switching 100k coroutines to other threads", "[.][benchmark]")
+{
+    const int coro_count = 100'000;
+
+    auto measure = [&](auto name, auto start_coroutine) {
+        std::latch done{coro_count};
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < coro_count; ++i)
+            start_coroutine(done);
+        done.wait();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << name << ": " << std::chrono::duration<double, std::micro>(elapsed).count() / coro_count << " us/switch\n";
+    };
+
+    measure("resume_on_new_thread", [](std::latch& done) { switch_on_new_thread(done); });
+
+    ThreadPoolScheduler scheduler;
+    measure("ThreadPoolScheduler", [&](std::latch& done) { switch_on_thread_pool(scheduler, done); });
+}
+
+Task<int> deep_chain(int depth)
+{
+    if (depth == 0)
+        co_return 0;
+
+    co_return co_await deep_chain(depth - 1) + 1;
+}
+
+Task<std::string> load_text(bool fails)
+{
+    if (fails)
+        throw std::runtime_error{"cannot load"};
+
+    co_return "text"s;
+}
+
+Task<size_t> text_length(bool fails)
+{
+    std::string text = co_await load_text(fails); // exception from load_text propagates through here
+    co_return text.size();
+}
+
+Task<std::thread::id> id_of_pool_thread(ThreadPoolScheduler& scheduler)
+{
+    co_await scheduler.schedule();
+    co_return std::this_thread::get_id();
+}
+
+TEST_CASE("Task - value & exception propagation")
+{
+    CHECK(sync_wait(text_length(false)) == 4);
+    CHECK_THROWS_AS(sync_wait(text_length(true)), std::runtime_error);
+}
+
+TEST_CASE("Task - deep co_await chain")
+{
+    // symmetric transfer is a tail call only in optimized gcc builds (always with clang) - without it every level
+    // takes stack, several KiB under ASan, so the depth stays small enough for debug & sanitizer builds
+    CHECK(sync_wait(deep_chain(1'000)) == 1'000);
+}
+
+TEST_CASE("Task - sync_wait for a task completed on the thread pool")
+{
+    ThreadPoolScheduler scheduler{2};
+
+    CHECK(sync_wait(id_of_pool_thread(scheduler)) != std::this_thread::get_id());
+}
+
+TEST_CASE("million-deep co_await chain", "[.][benchmark]")
+{
+    const int depth = 1'000'000;
+
+    const auto start = std::chrono::steady_clock::now();
+    const int result = sync_wait(deep_chain(depth));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Task chain of " << result << " co_awaits: " << std::chrono::duration<double, std::nano>(elapsed).count() / depth << " ns/level\n";
+}
+
+// counts allocations of coroutine frames
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    int allocation_count = 0;
+    int deallocation_count = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocation_count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        ++deallocation_count;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+Task<int> value_of(int value)
+{
+    co_return value;
+}
+
+// gcc pairs the operator new template taking allocator_arg with the sized operator delete & warns at -O0 - the pair
+// matches, as operator delete frees the frame through the memory resource kept in the FrameHeader before it
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+Task<int> value_of(std::allocator_arg_t, std::pmr::memory_resource*, int value) // frame from the memory resource
+{
+    co_return value;
+}
+#pragma GCC diagnostic pop
+
+// the address of the frame of the coroutine awaiting it
+struct FrameAddress
 {
+    void* address = nullptr;
 
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) noexcept
+    {
+        address = coroutine.address();
+        return false; // resumes right away
+    }
+
+    void* await_resume() const noexcept { return address; }
+};
+
+Task<void*> frame_address()
+{
+    co_return co_await FrameAddress{};
+}
+
+TEST_CASE("destroyed coroutine frame is reused from the FramePool")
+{
+    void* const first_frame = sync_wait(frame_address());
+    void* const second_frame = sync_wait(frame_address()); // sync_wait's own frame is not pooled
+
+    CHECK(second_frame == first_frame);
+}
+
+TEST_CASE("coroutine frame allocated from a memory resource")
+{
+    CountingResource resource;
+
+    {
+        auto task = value_of(std::allocator_arg, &resource, 42);
+        CHECK(resource.allocation_count == 1);
+
+        CHECK(sync_wait(std::move(task)) == 42);
+    }
+
+    CHECK(resource.deallocation_count == 1);
+}
+
+TEST_CASE("creating & destroying 1M coroutines", "[.][benchmark]")
+{
+    const int batch_size = 1'000;
+    const int batch_count = 1'000;
+
+    std::vector<Task<int>> tasks;
+    tasks.reserve(batch_size);
+
+    auto measure = [&](auto name, auto create_task) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int batch = 0; batch < batch_count; ++batch)
+        {
+            for (int i = 0; i < batch_size; ++i)
+                tasks.push_back(create_task(i));
+            tasks.clear();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << name << ": " << std::chrono::duration<double, std::nano>(elapsed).count() / (batch_size * batch_count) << " ns/coroutine\n";
+    };
+
+    measure("operator new (new_delete_resource)  ", [](int i) { return value_of(std::allocator_arg, std::pmr::new_delete_resource(), i); });
+    measure("FramePool                           ", [](int i) { return value_of(i); });
+
+    std::pmr::unsynchronized_pool_resource pool;
+    measure("unsynchronized_pool_resource        ", [&](int i) { return value_of(std::allocator_arg, &pool, i); });
+}
+
+// previous generator - a yielded value is copied into the promise
+namespace Legacy
+{
     template <typename T>
     class [[nodiscard]] Generator
     {
@@ -210,7 +486,7 @@ namespace FutureStd
 
         using CoroutineHandle = std::coroutine_handle<promise_type>;
 
-        struct promise_type
+        struct promise_type : PooledFrame
         {
             Generator get_return_object()
             {
@@ -325,7 +601,7 @@ namespace FutureStd
                 return {};
 
             iterator it{coroutine_hndl_};
-            it.next();
+            it.move_to_next();
             return it;
         }
 
@@ -352,7 +628,7 @@ namespace FutureStd
     private:
         CoroutineHandle coroutine_hndl_;
     };
-} // namespace FutureStd
+} // namespace Legacy
 
 using FutureStd::Generator;
 
@@ -371,4 +647,552 @@ TEST_CASE("fibonacci with generator")
     for (const auto& item : fibonacci(100))
         std::cout << item << " ";
     std::cout << "\n";
-}
\ No newline at end of file
+}
+
+static_assert(std::ranges::input_range<Generator<int>>);
+static_assert(std::ranges::view<Generator<int>>);
+static_assert(std::same_as<std::ranges::range_reference_t<Generator<int>>, int&&>);
+static_assert(std::same_as<std::ranges::range_reference_t<Generator<const std::string&>>, const std::string&>);
+
+TEST_CASE("generator is a view")
+{
+    auto even_fibonacci = fibonacci(1'000) | views::filter([](int n) { return n % 2 == 0; }) | views::take(4);
+
+    std::vector<int> items;
+    std::ranges::copy(even_fibonacci, std::back_inserter(items));
+
+    CHECK(items == std::vector{0, 2, 8, 34});
+}
+
+struct CopyCounter
+{
+    inline static int copy_count = 0;
+
+    std::string text;
+
+    explicit CopyCounter(std::string text)
+        : text{std::move(text)}
+    { }
+
+    CopyCounter(const CopyCounter& other)
+        : text{other.text}
+    {
+        ++copy_count;
+    }
+
+    CopyCounter& operator=(const CopyCounter&) = default;
+};
+
+Generator<const CopyCounter&> lines(const std::vector<CopyCounter>& source)
+{
+    for (const auto& line : source)
+        co_yield line;
+}
+
+TEST_CASE("generator of references yields without copies")
+{
+    const std::vector<CopyCounter> source{CopyCounter{"first"}, CopyCounter{"second"}};
+    CopyCounter::copy_count = 0;
+
+    std::vector<const CopyCounter*> yielded;
+    for (const CopyCounter& line : lines(source))
+        yielded.push_back(&line);
+
+    CHECK(CopyCounter::copy_count == 0);
+    CHECK(yielded == std::vector{&source[0], &source[1]});
+}
+
+struct TreeNode
+{
+    int value;
+    std::vector<TreeNode> children;
+};
+
+// every level of recursion is resumed directly by the consumer - not through the parents
+Generator<int> depth_first(const TreeNode& node)
+{
+    co_yield node.value;
+
+    for (const auto& child : node.children)
+        co_yield FutureStd::elements_of(depth_first(child));
+}
+
+Generator<int> countdown(int n)
+{
+    if (n == 0)
+        co_return;
+
+    co_yield n;
+    co_yield FutureStd::elements_of(countdown(n - 1));
+}
+
+TEST_CASE("recursive generator with elements_of")
+{
+    SECTION("tree")
+    {
+        const TreeNode tree{1, {{2, {{3, {}}, {4, {}}}}, {5, {}}}};
+
+        std::vector<int> values;
+        std::ranges::copy(depth_first(tree), std::back_inserter(values));
+
+        CHECK(values == std::vector{1, 2, 3, 4, 5});
+    }
+
+    SECTION("deep recursion")
+    {
+        int count = 0;
+        for (int n : countdown(1'000))
+            count += n;
+
+        CHECK(count == 500'500);
+    }
+
+    SECTION("other ranges")
+    {
+        auto mixed = []() -> Generator<int> {
+            const std::vector<int> items{1, 2};
+            co_yield FutureStd::elements_of(items); // lvalues copied
+            co_yield FutureStd::elements_of(fibonacci(4));
+            co_yield 3;
+        };
+
+        std::vector<int> values;
+        std::ranges::copy(mixed(), std::back_inserter(values));
+
+        CHECK(values == std::vector{1, 2, 0, 1, 1, 2, 3, 3});
+    }
+}
+
+Generator<int> failing_countdown(int n)
+{
+    if (n == 0)
+        throw std::runtime_error{"countdown failed"};
+
+    co_yield n;
+    co_yield FutureStd::elements_of(failing_countdown(n - 1));
+}
+
+TEST_CASE("exception from a nested generator")
+{
+    SECTION("propagates to the consumer")
+    {
+        std::vector<int> values;
+        CHECK_THROWS_AS(std::ranges::copy(failing_countdown(3), std::back_inserter(values)), std::runtime_error);
+        CHECK(values == std::vector{3, 2, 1});
+    }
+
+    SECTION("can be caught in the parent")
+    {
+        auto recovering = []() -> Generator<int> {
+            bool failed = false;
+            try
+            {
+                co_yield FutureStd::elements_of(failing_countdown(2));
+            }
+            catch (const std::runtime_error&)
+            {
+                failed = true;
+            }
+
+            if (failed)
+                co_yield -1;
+        };
+
+        std::vector<int> values;
+        std::ranges::copy(recovering(), std::back_inserter(values));
+
+        CHECK(values == std::vector{2, 1, -1});
+    }
+}
+
+template <template <typename> class TGenerator>
+TGenerator<std::string> words(const std::vector<std::string>& source)
+{
+    for (const auto& word : source)
+        co_yield word;
+}
+
+Generator<const std::string&> word_refs(const std::vector<std::string>& source)
+{
+    for (const auto& word : source)
+        co_yield word;
+}
+
+TEST_CASE("iterating 1M strings with generators", "[.][benchmark]")
+{
+    const std::vector<std::string> source(1'000'000, std::string(64, 'x'));
+
+    auto measure = [&](auto name, auto generate) {
+        size_t total_length = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const std::string& word : generate())
+            total_length += word.size();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(total_length == source.size() * 64);
+        std::cout << name << ": " << std::chrono::duration<double, std::nano>(elapsed).count() / source.size() << " ns/item\n";
+    };
+
+    measure("Legacy::Generator<std::string>          ", [&] { return words<Legacy::Generator>(source); });
+    measure("Generator<std::string> (copy of lvalue) ", [&] { return words<Generator>(source); });
+    measure("Generator<const std::string&>           ", [&] { return word_refs(source); });
+}
+
+// every item is "loaded" asynchronously before it is yielded
+AsyncGenerator<int> load_items(int count, int& produced_count)
+{
+    for (int i = 1; i <= count; ++i)
+    {
+        const int item = co_await value_of(i);
+        ++produced_count;
+        co_yield item;
+    }
+}
+
+// pipeline stage - consumes one async generator & produces another
+AsyncGenerator<std::string> describe(AsyncGenerator<int> items)
+{
+    while (auto item = co_await items.next())
+        co_yield "item#" + std::to_string(*item);
+}
+
+template <typename T>
+Task<std::vector<T>> collect(AsyncGenerator<T> items)
+{
+    std::vector<T> result;
+    while (auto item = co_await items.next())
+        result.push_back(std::move(*item));
+
+    co_return result;
+}
+
+AsyncGenerator<std::thread::id> ids_of_pool_threads(ThreadPoolScheduler& scheduler, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        co_await scheduler.schedule();
+        co_yield std::this_thread::get_id();
+    }
+}
+
+AsyncGenerator<int> failing_items()
+{
+    co_yield 1;
+    throw std::runtime_error{"broken stream"};
+}
+
+TEST_CASE("AsyncGenerator")
+{
+    int produced_count = 0;
+
+    SECTION("pipeline of async stages")
+    {
+        auto items = sync_wait(collect(describe(load_items(3, produced_count))));
+
+        CHECK(items == std::vector{"item#1"s, "item#2"s, "item#3"s});
+    }
+
+    SECTION("producer waits for the consumer - backpressure")
+    {
+        auto take_two = [](AsyncGenerator<int> items, int& produced_count) -> Task<int> {
+            int sum = *co_await items.next();
+            CHECK(produced_count == 1);
+            sum += *co_await items.next();
+            CHECK(produced_count == 2);
+            co_return sum;
+        };
+
+        CHECK(sync_wait(take_two(load_items(1'000, produced_count), produced_count)) == 3);
+        CHECK(produced_count == 2);
+    }
+
+    SECTION("producer resumed on the thread pool")
+    {
+        ThreadPoolScheduler scheduler{2};
+
+        auto ids = sync_wait(collect(ids_of_pool_threads(scheduler, 10)));
+
+        CHECK(ids.size() == 10);
+        CHECK(std::ranges::none_of(ids, [](auto id) { return id == std::this_thread::get_id(); }));
+    }
+
+    SECTION("exception propagates to the consumer")
+    {
+        CHECK_THROWS_AS(sync_wait(collect(failing_items())), std::runtime_error);
+    }
+}
+
+Generator<int> sync_numbers(int count)
+{
+    for (int i = 0; i < count; ++i)
+        co_yield i;
+}
+
+AsyncGenerator<int> async_numbers(int count)
+{
+    for (int i = 0; i < count; ++i)
+        co_yield i;
+}
+
+AsyncGenerator<int> async_loaded_numbers(int count)
+{
+    for (int i = 0; i < count; ++i)
+        co_yield co_await value_of(i);
+}
+
+Task<long> sum_of(AsyncGenerator<int> numbers)
+{
+    long sum = 0;
+    while (auto n = co_await numbers.next())
+        sum += *n;
+
+    co_return sum;
+}
+
+TEST_CASE("iterating 10M items with async generators", "[.][benchmark]")
+{
+    const int count = 10'000'000;
+    const long expected_sum = static_cast<long>(count) * (count - 1) / 2;
+
+    auto measure = [&](auto name, auto sum_items) {
+        const auto start = std::chrono::steady_clock::now();
+        const long sum = sum_items();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(sum == expected_sum);
+        std::cout << name << ": " << std::chrono::duration<double, std::nano>(elapsed).count() / count << " ns/item\n";
+    };
+
+    measure("Generator<int>                      ", [&] {
+        long sum = 0;
+        for (int n : sync_numbers(count))
+            sum += n;
+        return sum;
+    });
+    measure("AsyncGenerator<int>                 ", [&] { return sync_wait(sum_of(async_numbers(count))); });
+    measure("AsyncGenerator<int> + co_await Task ", [&] { return sync_wait(sum_of(async_loaded_numbers(count))); });
+}
+
+#ifdef __linux__
+
+// file removed at the end of a test
+class TempFile
+{
+    std::filesystem::path path_;
+    int fd_;
+
+public:
+    explicit TempFile(std::filesystem::path path)
+        : path_{std::move(path)}
+        , fd_{::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)}
+    {
+        if (fd_ < 0)
+            throw std::system_error{errno, std::system_category(), path_.string()};
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile()
+    {
+        ::close(fd_);
+        std::filesystem::remove(path_);
+    }
+
+    int fd() const noexcept
+    {
+        return fd_;
+    }
+};
+
+Detached copy_through_file(int fd, std::string text, std::string& text_read)
+{
+    const size_t written = co_await async_write(fd, std::as_bytes(std::span{text}), 0);
+
+    text_read.resize(written);
+    const size_t read = co_await async_read(fd, std::as_writable_bytes(std::span{text_read}), 0);
+    text_read.resize(read);
+}
+
+Detached read_pipe(int fd, std::string& text_read)
+{
+    std::array<std::byte, 64> buffer;
+    const size_t read = co_await async_read(fd, buffer); // waits for the writer
+    text_read.assign(reinterpret_cast<const char*>(buffer.data()), read);
+}
+
+Detached write_pipe(int fd, std::string text)
+{
+    co_await async_write(fd, std::as_bytes(std::span{text}));
+}
+
+Detached read_invalid_fd(std::error_code& error)
+{
+    try
+    {
+        std::array<std::byte, 16> buffer;
+        co_await async_read(-1, buffer);
+    }
+    catch (const std::system_error& e)
+    {
+        error = e.code();
+    }
+}
+
+TEST_CASE("async I/O on the event loop")
+{
+    // a generator, not a loop - Catch runs a section once per test case run, so a loop would skip it for the second backend
+    const auto backend = GENERATE(IoEventLoop::Backend::io_uring, IoEventLoop::Backend::epoll);
+    IoEventLoop loop{backend};
+    INFO("backend: " << (loop.backend() == IoEventLoop::Backend::io_uring ? "io_uring" : "epoll"));
+
+    SECTION("many files on one thread")
+    {
+        std::vector<std::unique_ptr<TempFile>> files;
+        std::vector<std::string> texts_read(10);
+
+        for (size_t i = 0; i < texts_read.size(); ++i)
+        {
+            files.push_back(std::make_unique<TempFile>(std::filesystem::temp_directory_path() / ("coro_io_" + std::to_string(::getpid()) + "_" + std::to_string(i))));
+            copy_through_file(files.back()->fd(), "text#" + std::to_string(i), texts_read[i]);
+        }
+
+        loop.run();
+
+        for (size_t i = 0; i < texts_read.size(); ++i)
+            CHECK(texts_read[i] == "text#" + std::to_string(i));
+    }
+
+    SECTION("reader resumed when data is written")
+    {
+        int pipe_fds[2];
+        REQUIRE(::pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC) == 0);
+
+        std::string text_read;
+        read_pipe(pipe_fds[0], text_read);
+        CHECK(text_read.empty());
+
+        write_pipe(pipe_fds[1], "through the pipe");
+        loop.run();
+
+        CHECK(text_read == "through the pipe");
+
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+
+    SECTION("read & write waiting for one socket")
+    {
+        int socket_fds[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, socket_fds) == 0);
+
+        std::array<char, 4096> buffer{};
+        while (::write(socket_fds[0], buffer.data(), buffer.size()) > 0)
+            ; // the socket buffer is full - the next write waits
+
+        std::string text_read;
+        read_pipe(socket_fds[0], text_read);
+        write_pipe(socket_fds[0], "sent");
+
+        while (::read(socket_fds[1], buffer.data(), buffer.size()) > 0)
+            ;
+        REQUIRE(::write(socket_fds[1], "received", 8) == 8);
+        loop.run(); // both operations resumed
+
+        CHECK(text_read == "received");
+        CHECK(::read(socket_fds[1], buffer.data(), buffer.size()) == 4);
+
+        ::close(socket_fds[0]);
+        ::close(socket_fds[1]);
+    }
+
+    SECTION("error reported as an exception")
+    {
+        std::error_code error;
+        read_invalid_fd(error);
+        loop.run();
+
+        CHECK(error == std::errc::bad_file_descriptor);
+    }
+}
+
+Detached read_whole_file(int fd, std::span<std::byte> buffer, size_t& total_read)
+{
+    for (size_t read; (read = co_await async_read(fd, buffer)) > 0;)
+        total_read += read;
+}
+
+Detached read_whole_file_on_pool(ThreadPoolScheduler& scheduler, int fd, std::span<std::byte> buffer, std::atomic<size_t>& total_read, std::latch& done)
+{
+    co_await scheduler.schedule();
+
+    for (ssize_t read; (read = ::read(fd, buffer.data(), buffer.size())) > 0;) // blocks the worker
+        total_read += static_cast<size_t>(read);
+
+    done.count_down();
+}
+
+TEST_CASE("reading 1000 files", "[.][benchmark]")
+{
+    const size_t file_count = 1'000;
+    const size_t file_size = 64 * 1024;
+    const size_t buffer_size = 16 * 1024;
+
+    const auto directory = std::filesystem::temp_directory_path() / ("coro_io_benchmark_" + std::to_string(::getpid()));
+    std::filesystem::create_directory(directory);
+
+    std::vector<std::unique_ptr<TempFile>> files;
+    const std::vector<char> content(file_size, 'x');
+    for (size_t i = 0; i < file_count; ++i)
+    {
+        files.push_back(std::make_unique<TempFile>(directory / std::to_string(i)));
+        REQUIRE(::write(files.back()->fd(), content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+    }
+
+    std::vector<std::byte> buffers(file_count * buffer_size);
+    auto buffer_of = [&](size_t i) { return std::span{buffers}.subspan(i * buffer_size, buffer_size); };
+
+    auto measure = [&](auto name, auto read_files) {
+        for (const auto& file : files)
+            ::lseek(file->fd(), 0, SEEK_SET);
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t total_read = read_files();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(total_read == file_count * file_size);
+        std::cout << name << ": " << std::chrono::duration<double, std::micro>(elapsed).count() / file_count << " us/file\n";
+    };
+
+    for (auto backend : {IoEventLoop::Backend::io_uring, IoEventLoop::Backend::epoll})
+    {
+        measure(backend == IoEventLoop::Backend::io_uring ? "IoEventLoop (io_uring), 1 thread     " : "IoEventLoop (epoll), 1 thread        ", [&] {
+            IoEventLoop loop{backend};
+
+            size_t total_read = 0;
+            for (size_t i = 0; i < file_count; ++i)
+                read_whole_file(files[i]->fd(), buffer_of(i), total_read);
+
+            loop.run();
+            return total_read;
+        });
+    }
+
+    measure("blocking reads on ThreadPoolScheduler", [&] {
+        ThreadPoolScheduler scheduler;
+
+        std::atomic<size_t> total_read{0};
+        std::latch done{file_count};
+        for (size_t i = 0; i < file_count; ++i)
+            read_whole_file_on_pool(scheduler, files[i]->fd(), buffer_of(i), total_read, done);
+
+        done.wait();
+        return total_read.load();
+    });
+
+    files.clear();
+    std::filesystem::remove(directory);
+}
+
+#endif // __linux__
@@ -0,0 +1,131 @@
+#ifndef FRAME_ALLOCATOR_HPP
+#define FRAME_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+// thread-local free lists of coroutine frames in size classes of 64 bytes - a frame freed on another thread
+// goes to the free list of that thread
+class FramePool
+{
+    static constexpr std::size_t granularity = 64;
+    static constexpr std::size_t size_class_count = 32; // frames up to 2 KiB - bigger ones go to operator new
+    static constexpr std::size_t max_free_count = 4096; // per size class - the rest goes back to operator delete
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct FreeLists
+    {
+        std::array<FreeBlock*, size_class_count> heads{};
+        std::array<std::size_t, size_class_count> counts{};
+
+        ~FreeLists()
+        {
+            for (FreeBlock* head : heads)
+                while (head)
+                    ::operator delete(std::exchange(head, head->next));
+        }
+    };
+
+    static thread_local FreeLists free_lists_;
+
+    static std::size_t size_class(std::size_t size) noexcept
+    {
+        return (size - 1) / granularity;
+    }
+
+public:
+    static void* allocate(std::size_t size)
+    {
+        const std::size_t index = size_class(size);
+        if (index >= size_class_count)
+            return ::operator new(size);
+
+        if (FreeBlock* block = free_lists_.heads[index])
+        {
+            free_lists_.heads[index] = block->next;
+            --free_lists_.counts[index];
+            return block;
+        }
+
+        return ::operator new((index + 1) * granularity);
+    }
+
+    static void deallocate(void* ptr, std::size_t size) noexcept
+    {
+        const std::size_t index = size_class(size);
+        if (index >= size_class_count || free_lists_.counts[index] == max_free_count)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        free_lists_.heads[index] = ::new (ptr) FreeBlock{free_lists_.heads[index]};
+        ++free_lists_.counts[index];
+    }
+};
+
+inline thread_local FramePool::FreeLists FramePool::free_lists_;
+
+// base for promise types - a coroutine frame comes from the FramePool, or from a memory resource if the coroutine
+// takes (std::allocator_arg_t, std::pmr::memory_resource*, ...) as its first parameters (after the object for members)
+struct PooledFrame
+{
+private:
+    // stored before a frame - operator delete gets no resource, so it frees the frame through the one stored here
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameHeader
+    {
+        std::pmr::memory_resource* resource; // nullptr for the FramePool
+        std::size_t size;
+    };
+
+    static void* tag(void* memory, std::size_t size, std::pmr::memory_resource* resource) noexcept
+    {
+        return ::new (memory) FrameHeader{resource, size} + 1;
+    }
+
+    static void release(void* frame) noexcept
+    {
+        FrameHeader* header = static_cast<FrameHeader*>(frame) - 1;
+
+        if (header->resource)
+            header->resource->deallocate(header, sizeof(FrameHeader) + header->size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        else
+            FramePool::deallocate(header, sizeof(FrameHeader) + header->size);
+    }
+
+public:
+    static void* operator new(std::size_t size)
+    {
+        return tag(FramePool::allocate(sizeof(FrameHeader) + size), size, nullptr);
+    }
+
+    template <typename... TArgs>
+    static void* operator new(std::size_t size, std::allocator_arg_t, std::pmr::memory_resource* resource, TArgs&&...)
+    {
+        return tag(resource->allocate(sizeof(FrameHeader) + size, __STDCPP_DEFAULT_NEW_ALIGNMENT__), size, resource);
+    }
+
+    template <typename TObject, typename... TArgs>
+    static void* operator new(std::size_t size, TObject&, std::allocator_arg_t, std::pmr::memory_resource* resource, TArgs&&...)
+    {
+        return tag(resource->allocate(sizeof(FrameHeader) + size, __STDCPP_DEFAULT_NEW_ALIGNMENT__), size, resource);
+    }
+
+    // frees frames from every operator new above - a coroutine frame is never freed through a placement delete
+    // (gcc's -Wmismatched-new-delete reports the allocator_arg forms anyway - see value_of() in coroutines.cpp)
+    static void operator delete(void* frame, std::size_t) noexcept
+    {
+        release(frame);
+    }
+};
+
+#endif // FRAME_ALLOCATOR_HPP
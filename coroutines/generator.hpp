@@ -0,0 +1,257 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include "frame_allocator.hpp"
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace FutureStd
+{
+    // co_yield elements_of(rng) - yields all elements of rng; a nested Generator is resumed directly by the consumer
+    template <std::ranges::range TRange>
+    struct elements_of
+    {
+        TRange range;
+    };
+
+    template <typename TRange>
+    elements_of(TRange&&) -> elements_of<TRange&&>;
+
+    // simplified std::generator (C++23) - a yielded object is referenced, not copied, while the generator is suspended
+    template <typename Ref, typename Value = void>
+    class [[nodiscard]] Generator : public std::ranges::view_interface<Generator<Ref, Value>>
+    {
+        using value = std::conditional_t<std::is_void_v<Value>, std::remove_cvref_t<Ref>, Value>;
+        using reference = std::conditional_t<std::is_void_v<Value>, Ref&&, Ref>;
+        using yielded = std::conditional_t<std::is_reference_v<reference>, reference, const reference&>;
+
+    public:
+        struct promise_type;
+
+        using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+        struct promise_type : PooledFrame
+        {
+            Generator get_return_object() noexcept
+            {
+                return Generator{CoroutineHandle::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() noexcept
+            {
+                struct FinalAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    // a nested generator transfers control back to its parent
+                    std::coroutine_handle<> await_suspend(CoroutineHandle coroutine) noexcept
+                    {
+                        promise_type& promise = coroutine.promise();
+                        if (!promise.parent_)
+                            return std::noop_coroutine();
+
+                        promise.root_->active_ = promise.parent_;
+                        return promise.parent_;
+                    }
+
+                    void await_resume() const noexcept { }
+                };
+
+                return FinalAwaiter{};
+            }
+
+            std::suspend_always yield_value(yielded value) noexcept
+            {
+                root_->value_ = std::addressof(value); // the yielded object lives until the generator is resumed
+                return {};
+            }
+
+            // an lvalue yielded from a generator of rvalue references is copied into the frame
+            auto yield_value(const std::remove_reference_t<yielded>& lvalue)
+                requires std::is_rvalue_reference_v<yielded>
+                && std::constructible_from<std::remove_cvref_t<yielded>, const std::remove_reference_t<yielded>&>
+            {
+                struct CopyAwaiter
+                {
+                    std::remove_cvref_t<yielded> copy;
+
+                    bool await_ready() const noexcept { return false; }
+
+                    void await_suspend(CoroutineHandle coroutine) noexcept
+                    {
+                        coroutine.promise().root_->value_ = std::addressof(copy);
+                    }
+
+                    void await_resume() const noexcept { }
+                };
+
+                return CopyAwaiter{lvalue};
+            }
+
+            auto yield_value(elements_of<Generator&&> nested) noexcept
+            {
+                struct NestedAwaiter
+                {
+                    Generator nested;
+
+                    bool await_ready() const noexcept { return !nested.coroutine_; }
+
+                    // the nested generator becomes the active one - the consumer resumes it without going through this one
+                    std::coroutine_handle<> await_suspend(CoroutineHandle coroutine) noexcept
+                    {
+                        promise_type& nested_promise = nested.coroutine_.promise();
+                        nested_promise.root_ = coroutine.promise().root_;
+                        nested_promise.parent_ = coroutine;
+                        nested_promise.root_->active_ = nested.coroutine_;
+
+                        return nested.coroutine_;
+                    }
+
+                    void await_resume()
+                    {
+                        if (nested.coroutine_ && nested.coroutine_.promise().exception_)
+                            std::rethrow_exception(nested.coroutine_.promise().exception_);
+                    }
+                };
+
+                return NestedAwaiter{std::move(nested.range)};
+            }
+
+            // other ranges (also generators of other types) are yielded element by element - lvalues are copied
+            // if the generator yields rvalue references
+            template <std::ranges::input_range TRange>
+                requires std::convertible_to<std::ranges::range_reference_t<TRange>, yielded>
+                || std::convertible_to<std::ranges::range_reference_t<TRange>, const std::remove_reference_t<yielded>&>
+            auto yield_value(elements_of<TRange> elements)
+            {
+                auto yield_all = [](std::ranges::iterator_t<TRange> first, std::ranges::sentinel_t<TRange> last) -> Generator {
+                    for (; first != last; ++first)
+                        co_yield *first;
+                };
+
+                return yield_value(elements_of{yield_all(std::ranges::begin(elements.range), std::ranges::end(elements.range))});
+            }
+
+            void await_transform() = delete; // co_await is not allowed in a generator
+
+            void return_void() const noexcept { }
+
+            // rethrown from the iterator (or from co_yield elements_of in the parent of a nested generator)
+            void unhandled_exception()
+            {
+                if (!parent_)
+                    throw;
+
+                exception_ = std::current_exception();
+            }
+
+        private:
+            friend class Generator;
+
+            std::add_pointer_t<yielded> value_ = nullptr; // used in the root
+            promise_type* root_ = this;
+            CoroutineHandle active_ = CoroutineHandle::from_promise(*this); // used in the root - the innermost nested generator
+            CoroutineHandle parent_ = nullptr;
+            std::exception_ptr exception_;
+        };
+
+        class iterator
+        {
+            CoroutineHandle coroutine_;
+
+            friend class Generator;
+
+            explicit iterator(CoroutineHandle coroutine) noexcept
+                : coroutine_{coroutine}
+            { }
+
+        public:
+            using value_type = value;
+            using difference_type = std::ptrdiff_t;
+
+            iterator(iterator&& other) noexcept
+                : coroutine_{std::exchange(other.coroutine_, nullptr)}
+            { }
+
+            iterator& operator=(iterator&& other) noexcept
+            {
+                coroutine_ = std::exchange(other.coroutine_, nullptr);
+                return *this;
+            }
+
+            reference operator*() const noexcept(std::is_nothrow_copy_constructible_v<reference>)
+            {
+                assert(coroutine_ && !coroutine_.done());
+                return static_cast<reference>(*coroutine_.promise().value_);
+            }
+
+            iterator& operator++()
+            {
+                assert(coroutine_ && !coroutine_.done());
+                coroutine_.promise().active_.resume();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept
+            {
+                return it.coroutine_.done();
+            }
+        };
+
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        Generator(Generator&& other) noexcept
+            : coroutine_{std::exchange(other.coroutine_, nullptr)}
+        { }
+
+        Generator& operator=(Generator&& other) noexcept
+        {
+            std::swap(coroutine_, other.coroutine_);
+            return *this;
+        }
+
+        ~Generator()
+        {
+            if (coroutine_)
+                coroutine_.destroy();
+        }
+
+        // may be called only once - the generator is an input range
+        iterator begin()
+        {
+            assert(coroutine_);
+            coroutine_.resume();
+            return iterator{coroutine_};
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return {};
+        }
+
+    private:
+        CoroutineHandle coroutine_ = nullptr;
+
+        explicit Generator(CoroutineHandle coroutine) noexcept
+            : coroutine_{coroutine}
+        { }
+    };
+} // namespace FutureStd
+
+#endif // GENERATOR_HPP
@@ -0,0 +1,443 @@
+#ifndef IO_EVENT_LOOP_HPP
+#define IO_EVENT_LOOP_HPP
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// single-threaded event loop for asynchronous reads & writes - a coroutine awaiting an operation is resumed
+// by run() when the operation completes, so many operations can be in flight on one thread
+//  * io_uring (used through raw syscalls) - works also for regular files
+//  * epoll - fallback if io_uring is not available (or is disabled); operations on descriptors that epoll
+//    cannot wait for (e.g. regular files) are performed at once, blocking the thread
+class IoEventLoop
+{
+public:
+    enum class Backend
+    {
+        io_uring,
+        epoll
+    };
+
+private:
+    // state of an awaited operation - lives in the frame of the awaiting coroutine
+    struct Operation
+    {
+        IoEventLoop& loop;
+        int fd;
+        void* buffer;
+        std::size_t size;
+        std::int64_t offset; // -1 - at the current file position
+        bool is_write;
+        int result = 0; // transferred bytes or -errno
+        std::coroutine_handle<> coroutine = nullptr;
+
+        // epoll: performs the operation without blocking (unless the descriptor is a regular file)
+        void perform() noexcept
+        {
+            ssize_t transferred;
+            if (is_write)
+                transferred = offset < 0 ? ::write(fd, buffer, size) : ::pwrite(fd, buffer, size, offset);
+            else
+                transferred = offset < 0 ? ::read(fd, buffer, size) : ::pread(fd, buffer, size, offset);
+
+            result = transferred < 0 ? -errno : static_cast<int>(transferred); // size is at most max_transfer_size
+        }
+    };
+
+    struct IoAwaiter : Operation
+    {
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> awaiting_coroutine)
+        {
+            coroutine = awaiting_coroutine;
+            return loop.submit(*this); // false - completed at once
+        }
+
+        std::size_t await_resume() const
+        {
+            if (result < 0)
+                throw std::system_error{-result, std::system_category(), is_write ? "async_write" : "async_read"};
+
+            return static_cast<std::size_t>(result);
+        }
+    };
+
+    struct Ring
+    {
+        int fd = -1;
+        void* rings = MAP_FAILED;
+        std::size_t rings_size = 0;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        std::size_t sqes_size = 0;
+
+        unsigned* sq_head;
+        unsigned* sq_tail;
+        unsigned sq_mask;
+        unsigned sq_entries;
+        unsigned* sq_array;
+
+        unsigned* cq_head;
+        unsigned* cq_tail;
+        unsigned cq_mask;
+        io_uring_cqe* cqes;
+
+        unsigned unsubmitted_count = 0;
+    };
+
+    // epoll: operations waiting for readiness of a descriptor - one read & one write at a time
+    struct FdWaiters
+    {
+        Operation* reader = nullptr;
+        Operation* writer = nullptr;
+    };
+
+    // results are ints (cqe.res) - a bigger buffer is transferred partially, as read(2) & write(2) may do anyway
+    static constexpr std::size_t max_transfer_size = std::numeric_limits<int>::max();
+
+    Backend backend_;
+    Ring ring_;
+    int epoll_fd_ = -1;
+    std::unordered_map<int, FdWaiters> fd_waiters_;
+    std::size_t pending_count_ = 0; // operations not completed yet
+
+    inline static thread_local IoEventLoop* current_loop_ = nullptr;
+
+    static std::system_error last_error(const char* what)
+    {
+        return std::system_error{errno, std::system_category(), what};
+    }
+
+    // false if io_uring is not available
+    bool setup_ring(unsigned entries)
+    {
+        io_uring_params params{};
+        ring_.fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_.fd < 0)
+            return false;
+
+        // kernels older than 5.6 - no IORING_OP_READ/WRITE at the current file position, completions lost
+        // if the CQ ring overflows
+        if (!(params.features & IORING_FEAT_RW_CUR_POS) || !(params.features & IORING_FEAT_NODROP))
+            return false;
+
+        ring_.rings_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring_.rings = ::mmap(nullptr, ring_.rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_.fd, IORING_OFF_SQ_RING);
+        if (ring_.rings == MAP_FAILED)
+            return false;
+
+        ring_.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring_.sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, ring_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_.fd, IORING_OFF_SQES));
+        if (ring_.sqes == MAP_FAILED)
+            return false;
+
+        auto* rings = static_cast<std::byte*>(ring_.rings);
+        ring_.sq_head = reinterpret_cast<unsigned*>(rings + params.sq_off.head);
+        ring_.sq_tail = reinterpret_cast<unsigned*>(rings + params.sq_off.tail);
+        ring_.sq_mask = *reinterpret_cast<unsigned*>(rings + params.sq_off.ring_mask);
+        ring_.sq_entries = params.sq_entries;
+        ring_.sq_array = reinterpret_cast<unsigned*>(rings + params.sq_off.array);
+        ring_.cq_head = reinterpret_cast<unsigned*>(rings + params.cq_off.head);
+        ring_.cq_tail = reinterpret_cast<unsigned*>(rings + params.cq_off.tail);
+        ring_.cq_mask = *reinterpret_cast<unsigned*>(rings + params.cq_off.ring_mask);
+        ring_.cqes = reinterpret_cast<io_uring_cqe*>(rings + params.cq_off.cqes);
+
+        return true;
+    }
+
+    void close_ring() noexcept
+    {
+        if (ring_.sqes != MAP_FAILED)
+            ::munmap(ring_.sqes, ring_.sqes_size);
+        if (ring_.rings != MAP_FAILED)
+            ::munmap(ring_.rings, ring_.rings_size);
+        if (ring_.fd >= 0)
+            ::close(ring_.fd);
+
+        ring_ = Ring{};
+    }
+
+    // submits queued SQEs & waits for at least min_complete completions
+    void enter(unsigned min_complete)
+    {
+        while (true)
+        {
+            const long submitted = ::syscall(__NR_io_uring_enter, ring_.fd, ring_.unsubmitted_count, min_complete,
+                min_complete ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+
+            if (submitted >= 0)
+            {
+                ring_.unsubmitted_count -= static_cast<unsigned>(submitted);
+                return;
+            }
+
+            if (errno == EAGAIN || errno == EBUSY)
+                return; // completions must be reaped first
+
+            if (errno != EINTR)
+                throw last_error("io_uring_enter");
+        }
+    }
+
+    bool submit(Operation& operation)
+    {
+        if (backend_ == Backend::io_uring)
+            return submit_to_ring(operation);
+
+        return submit_to_epoll(operation);
+    }
+
+    bool submit_to_ring(Operation& operation)
+    {
+        unsigned tail = *ring_.sq_tail; // written only by this thread
+        if (tail - std::atomic_ref{*ring_.sq_head}.load(std::memory_order_acquire) == ring_.sq_entries)
+        {
+            enter(0); // SQ ring is full - the kernel consumes the queued SQEs
+            if (tail - std::atomic_ref{*ring_.sq_head}.load(std::memory_order_acquire) == ring_.sq_entries)
+                throw std::system_error{EBUSY, std::system_category(), "io_uring submission queue is full"};
+        }
+
+        const unsigned index = tail & ring_.sq_mask;
+        io_uring_sqe& sqe = ring_.sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = operation.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = operation.fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(operation.buffer);
+        assert(operation.size <= max_transfer_size); // also fits sqe.len
+        sqe.len = static_cast<std::uint32_t>(operation.size);
+        sqe.off = static_cast<std::uint64_t>(operation.offset);
+        sqe.user_data = reinterpret_cast<std::uint64_t>(&operation);
+        ring_.sq_array[index] = index;
+
+        std::atomic_ref{*ring_.sq_tail}.store(tail + 1, std::memory_order_release);
+        ++ring_.unsubmitted_count; // submitted in a batch by run()
+        ++pending_count_;
+
+        return true;
+    }
+
+    bool submit_to_epoll(Operation& operation)
+    {
+        operation.perform();
+        if (operation.result != -EAGAIN && operation.result != -EWOULDBLOCK)
+            return false;
+
+        wait_for_readiness(operation);
+        ++pending_count_;
+
+        return true;
+    }
+
+    // a read & a write may wait for the same descriptor - a second read (or write) throws
+    void wait_for_readiness(Operation& operation)
+    {
+        FdWaiters& waiters = fd_waiters_[operation.fd];
+        Operation*& waiter = operation.is_write ? waiters.writer : waiters.reader;
+        if (waiter)
+            throw std::system_error{EBUSY, std::system_category(), operation.is_write ? "async_write already waits for the descriptor" : "async_read already waits for the descriptor"};
+
+        waiter = &operation;
+        watch(operation.fd, waiters);
+    }
+
+    // one-shot - rearmed after every event while an operation still waits
+    void watch(int fd, const FdWaiters& waiters)
+    {
+        epoll_event event{};
+        event.events = (waiters.reader ? EPOLLIN : 0u) | (waiters.writer ? EPOLLOUT : 0u) | EPOLLONESHOT;
+        event.data.fd = fd;
+
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0)
+            return;
+
+        if (errno != ENOENT || ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+            throw last_error("epoll_ctl");
+    }
+
+    void complete(Operation& operation)
+    {
+        --pending_count_;
+        operation.coroutine.resume(); // may submit next operations
+    }
+
+    void run_ring()
+    {
+        while (pending_count_ > 0)
+        {
+            enter(1);
+
+            unsigned head = *ring_.cq_head; // written only by this thread
+            const unsigned tail = std::atomic_ref{*ring_.cq_tail}.load(std::memory_order_acquire);
+
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe& cqe = ring_.cqes[head & ring_.cq_mask];
+                auto& operation = *reinterpret_cast<Operation*>(cqe.user_data);
+                operation.result = cqe.res;
+
+                std::atomic_ref{*ring_.cq_head}.store(head + 1, std::memory_order_release); // the entry may be reused
+                complete(operation);
+            }
+        }
+    }
+
+    void run_epoll()
+    {
+        epoll_event events[64];
+
+        while (pending_count_ > 0)
+        {
+            const int ready_count = ::epoll_wait(epoll_fd_, events, static_cast<int>(std::size(events)), -1);
+            if (ready_count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw last_error("epoll_wait");
+            }
+
+            for (int i = 0; i < ready_count; ++i)
+            {
+                const int fd = events[i].data.fd;
+                FdWaiters& waiters = fd_waiters_[fd];
+                const bool has_failed = events[i].events & (EPOLLERR | EPOLLHUP); // the operations report the error
+
+                Operation* completed[2] = {};
+                if (waiters.reader && (events[i].events & EPOLLIN || has_failed))
+                    completed[0] = std::exchange(waiters.reader, nullptr);
+                if (waiters.writer && (events[i].events & EPOLLOUT || has_failed))
+                    completed[1] = std::exchange(waiters.writer, nullptr);
+
+                for (Operation*& operation : completed)
+                {
+                    if (!operation)
+                        continue;
+
+                    operation->perform();
+                    if (operation->result == -EAGAIN || operation->result == -EWOULDBLOCK) // spurious readiness
+                    {
+                        (operation->is_write ? waiters.writer : waiters.reader) = operation;
+                        operation = nullptr;
+                    }
+                }
+
+                if (waiters.reader || waiters.writer)
+                    watch(fd, waiters);
+
+                for (Operation* operation : completed)
+                    if (operation)
+                        complete(*operation); // may wait for the descriptor again - the reference to waiters stays valid
+            }
+        }
+    }
+
+public:
+    // io_uring with epoll as the fallback
+    explicit IoEventLoop(unsigned entries = 256)
+        : IoEventLoop{Backend::io_uring, entries}
+    { }
+
+    IoEventLoop(Backend backend, unsigned entries = 256)
+        : backend_{backend}
+    {
+        assert(current_loop_ == nullptr); // one loop per thread
+
+        if (backend_ == Backend::io_uring && !setup_ring(entries))
+        {
+            close_ring();
+            backend_ = Backend::epoll;
+        }
+
+        if (backend_ == Backend::epoll)
+        {
+            epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd_ < 0)
+                throw last_error("epoll_create1");
+        }
+
+        current_loop_ = this;
+    }
+
+    IoEventLoop(const IoEventLoop&) = delete;
+    IoEventLoop& operator=(const IoEventLoop&) = delete;
+
+    // operations must not be pending
+    ~IoEventLoop()
+    {
+        assert(pending_count_ == 0);
+
+        close_ring();
+        if (epoll_fd_ >= 0)
+            ::close(epoll_fd_);
+
+        current_loop_ = nullptr;
+    }
+
+    // loop created on the calling thread
+    static IoEventLoop& current() noexcept
+    {
+        assert(current_loop_ != nullptr);
+        return *current_loop_;
+    }
+
+    Backend backend() const noexcept
+    {
+        return backend_;
+    }
+
+    // co_await loop.read(...) - number of bytes read (0 at the end of file); throws std::system_error
+    auto read(int fd, std::span<std::byte> buffer, std::int64_t offset = -1) noexcept
+    {
+        return IoAwaiter{{*this, fd, buffer.data(), std::min(buffer.size(), max_transfer_size), offset, false}};
+    }
+
+    // co_await loop.write(...) - number of bytes written; throws std::system_error
+    auto write(int fd, std::span<const std::byte> buffer, std::int64_t offset = -1) noexcept
+    {
+        return IoAwaiter{{*this, fd, const_cast<std::byte*>(buffer.data()), std::min(buffer.size(), max_transfer_size), offset, true}};
+    }
+
+    // resumes coroutines as their operations complete - returns when no operation is pending
+    void run()
+    {
+        if (backend_ == Backend::io_uring)
+            run_ring();
+        else
+            run_epoll();
+    }
+};
+
+// co_await async_read(fd, buffer) - reads with the event loop of the calling thread
+inline auto async_read(int fd, std::span<std::byte> buffer, std::int64_t offset = -1) noexcept
+{
+    return IoEventLoop::current().read(fd, buffer, offset);
+}
+
+// co_await async_write(fd, buffer) - writes with the event loop of the calling thread
+inline auto async_write(int fd, std::span<const std::byte> buffer, std::int64_t offset = -1) noexcept
+{
+    return IoEventLoop::current().write(fd, buffer, offset);
+}
+
+#endif // __linux__
+
+#endif // IO_EVENT_LOOP_HPP
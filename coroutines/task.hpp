@@ -0,0 +1,281 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include "frame_allocator.hpp"
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+template <typename T = void>
+class Task;
+
+namespace TaskDetails
+{
+    class PromiseBase : public PooledFrame
+    {
+        std::coroutine_handle<> continuation_ = std::noop_coroutine();
+
+    public:
+        std::suspend_always initial_suspend() const noexcept { return {}; } // lazy - started by co_await
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+
+                // symmetric transfer - the awaiting coroutine is resumed without a nested call, so the stack
+                // does not grow with the depth of a co_await chain
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<>) noexcept
+                {
+                    return continuation;
+                }
+
+                void await_resume() const noexcept { }
+
+                std::coroutine_handle<> continuation;
+            };
+
+            return FinalAwaiter{continuation_};
+        }
+
+        void set_continuation(std::coroutine_handle<> continuation) noexcept
+        {
+            continuation_ = continuation;
+        }
+    };
+
+    template <typename T>
+    class Promise : public PromiseBase
+    {
+        std::variant<std::monostate, T, std::exception_ptr> result_;
+
+    public:
+        Task<T> get_return_object() noexcept;
+
+        template <typename TValue = T>
+            requires std::convertible_to<TValue&&, T>
+        void return_value(TValue&& value) noexcept(std::is_nothrow_constructible_v<T, TValue&&>)
+        {
+            result_.template emplace<1>(std::forward<TValue>(value));
+        }
+
+        void unhandled_exception() noexcept
+        {
+            result_.template emplace<2>(std::current_exception());
+        }
+
+        T result() &&
+        {
+            if (result_.index() == 2)
+                std::rethrow_exception(std::get<2>(result_));
+
+            return std::get<1>(std::move(result_));
+        }
+    };
+
+    template <>
+    class Promise<void> : public PromiseBase
+    {
+        std::exception_ptr exception_;
+
+    public:
+        Task<void> get_return_object() noexcept;
+
+        void return_void() noexcept { }
+
+        void unhandled_exception() noexcept
+        {
+            exception_ = std::current_exception();
+        }
+
+        void result() &&
+        {
+            if (exception_)
+                std::rethrow_exception(exception_);
+        }
+    };
+} // namespace TaskDetails
+
+// lazily started coroutine - co_await starts it & returns its value (or rethrows its exception)
+template <typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = TaskDetails::Promise<T>;
+    using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+    explicit Task(CoroutineHandle coroutine) noexcept
+        : coroutine_{coroutine}
+    { }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : coroutine_{std::exchange(other.coroutine_, nullptr)}
+    { }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (coroutine_)
+                coroutine_.destroy();
+            coroutine_ = std::exchange(other.coroutine_, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (coroutine_)
+            coroutine_.destroy();
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct TaskAwaiter
+        {
+            CoroutineHandle coroutine;
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+            {
+                coroutine.promise().set_continuation(awaiting_coroutine);
+                return coroutine; // symmetric transfer - starts the task
+            }
+
+            T await_resume()
+            {
+                return std::move(coroutine.promise()).result();
+            }
+        };
+
+        return TaskAwaiter{coroutine_};
+    }
+
+private:
+    CoroutineHandle coroutine_;
+
+    template <typename TResult>
+    friend TResult sync_wait(Task<TResult> task);
+};
+
+template <typename T>
+Task<T> TaskDetails::Promise<T>::get_return_object() noexcept
+{
+    return Task<T>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+inline Task<void> TaskDetails::Promise<void>::get_return_object() noexcept
+{
+    return Task<void>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+namespace TaskDetails
+{
+    struct SyncWaitEvent
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool is_set = false;
+
+        void set()
+        {
+            std::lock_guard lk{mtx}; // waiting thread cannot destroy the event before notify_one() returns
+            is_set = true;
+            cv.notify_one();
+        }
+
+        void wait()
+        {
+            std::unique_lock lk{mtx};
+            cv.wait(lk, [this] { return is_set; });
+        }
+    };
+
+    // continuation of the awaited task - signals the blocked thread
+    struct SyncWaitCoroutine
+    {
+        struct promise_type
+        {
+            SyncWaitEvent* event;
+
+            SyncWaitCoroutine get_return_object() noexcept
+            {
+                return SyncWaitCoroutine{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() noexcept
+            {
+                struct SignalAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    // signaled after the suspension - the blocked thread may destroy the frame right away
+                    void await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept { coroutine.promise().event->set(); }
+
+                    void await_resume() const noexcept { }
+                };
+
+                return SignalAwaiter{};
+            }
+
+            void return_void() noexcept { }
+
+            void unhandled_exception() noexcept { std::terminate(); } // exceptions stay in the awaited task
+        };
+
+        std::coroutine_handle<promise_type> coroutine;
+
+        ~SyncWaitCoroutine()
+        {
+            coroutine.destroy();
+        }
+    };
+} // namespace TaskDetails
+
+// blocks the calling thread until the task completes - also if it completes on another thread
+template <typename T>
+T sync_wait(Task<T> task)
+{
+    TaskDetails::SyncWaitEvent event;
+
+    auto wait_for = [](typename Task<T>::CoroutineHandle task_coroutine) -> TaskDetails::SyncWaitCoroutine {
+        struct WhenReady
+        {
+            typename Task<T>::CoroutineHandle task_coroutine;
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+            {
+                task_coroutine.promise().set_continuation(awaiting_coroutine);
+                return task_coroutine;
+            }
+
+            void await_resume() const noexcept { } // the result is taken by sync_wait
+        };
+
+        co_await WhenReady{task_coroutine};
+    };
+
+    TaskDetails::SyncWaitCoroutine waiter = wait_for(task.coroutine_);
+    waiter.coroutine.promise().event = &event;
+    waiter.coroutine.resume();
+    event.wait();
+
+    return std::move(task.coroutine_.promise()).result();
+}
+
+#endif // TASK_HPP
@@ -0,0 +1,161 @@
+#ifndef THREAD_POOL_SCHEDULER_HPP
+#define THREAD_POOL_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// resumes coroutines on a fixed set of worker threads - co_await scheduler.schedule() moves the coroutine to the pool
+//  * every worker has its own FIFO queue: coroutines scheduled from a worker go to its queue,
+//    coroutines scheduled from other threads are spread round-robin
+//  * an idle worker steals the oldest coroutine from other queues
+class ThreadPoolScheduler
+{
+    static constexpr std::size_t cache_line_size = 64; // fixed - std::hardware_destructive_interference_size changes with -mtune and gcc warns about it in headers
+
+    struct alignas(cache_line_size) WorkerQueue
+    {
+        std::mutex mtx;
+        std::deque<std::coroutine_handle<>> coroutines;
+    };
+
+    std::vector<WorkerQueue> queues_;
+    std::atomic<std::size_t> queued_count_{0}; // idle workers wait on it
+    std::atomic<std::size_t> next_queue_{0};
+    std::atomic<bool> is_stopping_{false};
+    std::vector<std::jthread> workers_;
+
+    inline static thread_local ThreadPoolScheduler* current_scheduler_ = nullptr;
+    inline static thread_local std::size_t current_worker_ = 0;
+
+    void push(std::coroutine_handle<> coroutine)
+    {
+        const std::size_t index = current_scheduler_ == this
+            ? current_worker_
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+        {
+            std::lock_guard lk{queues_[index].mtx};
+            queues_[index].coroutines.push_back(coroutine);
+        }
+
+        queued_count_.fetch_add(1, std::memory_order_release);
+        queued_count_.notify_one();
+    }
+
+    std::optional<std::coroutine_handle<>> pop_own(std::size_t index)
+    {
+        std::lock_guard lk{queues_[index].mtx};
+
+        auto& coroutines = queues_[index].coroutines;
+        if (coroutines.empty())
+            return std::nullopt;
+
+        auto coroutine = coroutines.front(); // oldest first - a coroutine that reschedules itself cannot starve the others
+        coroutines.pop_front();
+        return coroutine;
+    }
+
+    std::optional<std::coroutine_handle<>> steal(std::size_t thief_index)
+    {
+        for (std::size_t offset = 1; offset < queues_.size(); ++offset)
+        {
+            auto& victim = queues_[(thief_index + offset) % queues_.size()];
+
+            std::unique_lock lk{victim.mtx, std::try_to_lock}; // a busy victim is skipped
+            if (lk && !victim.coroutines.empty())
+            {
+                auto coroutine = victim.coroutines.front();
+                victim.coroutines.pop_front();
+                return coroutine;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void run(std::size_t index)
+    {
+        current_scheduler_ = this;
+        current_worker_ = index;
+
+        while (true)
+        {
+            auto coroutine = pop_own(index);
+            if (!coroutine)
+                coroutine = steal(index);
+
+            if (coroutine)
+            {
+                queued_count_.fetch_sub(1, std::memory_order_relaxed);
+                coroutine->resume();
+                continue;
+            }
+
+            if (is_stopping_.load(std::memory_order_acquire))
+                return; // coroutines scheduled by running ones go to their worker's own queue
+
+            queued_count_.wait(0, std::memory_order_acquire); // returns at once if a coroutine is queued or in transit
+        }
+    }
+
+public:
+    explicit ThreadPoolScheduler(std::size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
+        : queues_(std::max<std::size_t>(thread_count, 1))
+    {
+        workers_.reserve(queues_.size());
+        for (std::size_t i = 0; i < queues_.size(); ++i)
+            workers_.emplace_back([this, i] { run(i); });
+    }
+
+    ThreadPoolScheduler(const ThreadPoolScheduler&) = delete;
+    ThreadPoolScheduler& operator=(const ThreadPoolScheduler&) = delete;
+
+    // coroutines queued before the destruction are resumed first
+    ~ThreadPoolScheduler()
+    {
+        is_stopping_.store(true, std::memory_order_release);
+        queued_count_.fetch_add(1, std::memory_order_release); // wakes idle workers
+        queued_count_.notify_all();
+
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    std::size_t thread_count() const noexcept
+    {
+        return workers_.size();
+    }
+
+    auto schedule()
+    {
+        struct ScheduleAwaiter
+        {
+            ThreadPoolScheduler& scheduler;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine)
+            {
+                scheduler.push(coroutine);
+            }
+
+            void await_resume() const noexcept
+            { }
+        };
+
+        return ScheduleAwaiter{*this};
+    }
+};
+
+#endif // THREAD_POOL_SCHEDULER_HPP
@@ -2,57 +2,605 @@ module; // start module unit with global module fragment
 
 export module EShop;
 
-import <iostream>;
-import <string>;
-import <vector>;
+import "eshop_std.hpp";
 
 namespace std _GLIBCXX_VISIBILITY(default){} // Fix for gcc 12.2 & import <vector> or any std container
 
 struct Order
 {
     unsigned int count;
-    std::string name;
+    uint32_t name_id; // handle from NameTable
     double price;
+};
+
+// interned names stored back to back in arena blocks - ids & string_views stay valid for the lifetime of the table
+class NameTable
+{
+    static constexpr size_t first_block_size = 1024;
+    static constexpr size_t max_block_size = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* free_space_ = nullptr;
+    size_t free_size_ = 0;
+    size_t next_block_size_ = first_block_size;
+    size_t arena_size_ = 0;
+
+    std::vector<std::string_view> names_; // indexed by id
+
+    static constexpr uint32_t empty_slot = ~0u;
+
+    struct Slot
+    {
+        uint32_t hash = 0; // upper half of the name's hash - skips most string comparisons
+        uint32_t id = empty_slot;
+    };
+
+    std::vector<Slot> slots_; // open addressing with linear probing - at most half full
+
+    // multiplicative hash reading 8 bytes at a time - the last word overlaps the previous one instead of a byte loop
+    static uint64_t hash(std::string_view name)
+    {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+        uint64_t hash = name.size() * multiplier;
+        uint64_t word = 0;
+
+        if (name.size() >= 8)
+        {
+            for (size_t i = 0; i + 8 < name.size(); i += 8)
+            {
+                std::memcpy(&word, name.data() + i, 8);
+                hash = std::rotl((hash ^ word) * multiplier, 29);
+            }
+
+            std::memcpy(&word, name.data() + name.size() - 8, 8);
+        }
+        else
+        {
+            for (char c : name)
+                word = word << 8 | static_cast<unsigned char>(c);
+        }
+
+        hash = (hash ^ word) * multiplier;
+
+        return hash ^ (hash >> 29);
+    }
+
+    void grow()
+    {
+        slots_.assign(std::max<size_t>(16, 2 * slots_.size()), Slot{});
+
+        const size_t mask = slots_.size() - 1;
+        for (uint32_t id = 0; id < names_.size(); ++id)
+        {
+            const uint64_t name_hash = hash(names_[id]);
+
+            size_t index = name_hash & mask;
+            while (slots_[index].id != empty_slot)
+                index = (index + 1) & mask;
+
+            slots_[index] = Slot{static_cast<uint32_t>(name_hash >> 32), id};
+        }
+    }
+
+    char* allocate(size_t size)
+    {
+        if (size > max_block_size / 4) // long names get a block of their own - the current block stays in use
+        {
+            arena_size_ += size;
+            return blocks_.emplace_back(std::make_unique_for_overwrite<char[]>(size)).get();
+        }
+
+        if (size > free_size_)
+        {
+            free_space_ = blocks_.emplace_back(std::make_unique_for_overwrite<char[]>(next_block_size_)).get();
+            free_size_ = next_block_size_;
+            arena_size_ += next_block_size_;
+            next_block_size_ = std::min(2 * next_block_size_, max_block_size);
+        }
+
+        char* data = free_space_;
+        free_space_ += size;
+        free_size_ -= size;
+        return data;
+    }
 
-    Order(unsigned int count, std::string order_name, double price)
-        : count{count}
-        , name{std::move(order_name)}
+public:
+    NameTable() = default;
+    NameTable(const NameTable&) = delete; // views in names_ refer to blocks_
+    NameTable& operator=(const NameTable&) = delete;
+    NameTable(NameTable&&) = default; // blocks are moved, not copied - views stay valid
+    NameTable& operator=(NameTable&&) = default;
+
+    // copies name into the arena only the first time it is seen
+    uint32_t intern(std::string_view name)
+    {
+        if (2 * (names_.size() + 1) > slots_.size())
+            grow();
+
+        const uint64_t name_hash = hash(name);
+        const auto hash_tag = static_cast<uint32_t>(name_hash >> 32);
+        const size_t mask = slots_.size() - 1;
+
+        size_t index = name_hash & mask;
+        for (; slots_[index].id != empty_slot; index = (index + 1) & mask)
+            if (slots_[index].hash == hash_tag && names_[slots_[index].id] == name)
+                return slots_[index].id;
+
+        char* data = allocate(name.size());
+        std::copy_n(name.data(), name.size(), data);
+
+        const auto id = static_cast<uint32_t>(names_.size());
+        names_.push_back(std::string_view{data, name.size()});
+        slots_[index] = Slot{hash_tag, id};
+
+        return id;
+    }
+
+    std::string_view operator[](uint32_t id) const
+    {
+        return names_[id];
+    }
+
+    size_t size() const
+    {
+        return names_.size();
+    }
+
+    size_t memory_usage() const;
+};
+
+std::string_view intern_name(std::string_view name); // not exported - thread-safe, the view stays valid until exit
+
+// inline copy of a name - longer names are interned once per thread, so events stay trivially copyable & publishing
+// never locks after a thread's first long name (a long name still costs a hash lookup per event)
+// (not a template - gcc 12 miscompiles class template members used both in the interface & in importers)
+class ShortString
+{
+    static constexpr size_t capacity = 39; // names up to 39 chars are copied - size_ & data_ fill 40 bytes
+
+    char data_[capacity]{};
+    uint8_t size_ = 0;
+    std::string_view long_text_; // set for names that do not fit into data_
+
+public:
+    ShortString() = default;
+
+    ShortString(std::string_view text)
+    {
+        if (text.size() <= capacity)
+        {
+            size_ = static_cast<uint8_t>(text.size());
+            std::copy_n(text.data(), size_, data_);
+        }
+        else
+            long_text_ = intern_name(text);
+    }
+
+    std::string_view view() const
+    {
+        return long_text_.empty() ? std::string_view{data_, size_} : long_text_;
+    }
+};
+
+export struct OrderEvent
+{
+    ShortString customer;
+    ShortString order_name;
+    unsigned int count = 0;
+    double price = 0.0;
+
+    OrderEvent() = default;
+
+    OrderEvent(std::string_view customer, unsigned int count, std::string_view order_name, double price)
+        : customer{customer}
+        , order_name{order_name}
+        , count{count}
         , price{price}
     { }
 };
 
-void print(const Order& order); // not exported
+void print(std::ostream& out, const OrderEvent& event); // not exported
+
+// receives an event for every order placed by a Customer
+export class OrderSink
+{
+public:
+    virtual ~OrderSink(); // defined below the class - gcc 12 crashes cloning an inline one & emits the vtable with it
+    virtual void publish(const OrderEvent& event) noexcept = 0;
+};
+
+OrderSink::~OrderSink() = default;
+
+// discards events - for benchmarks
+export class NullOrderSink : public OrderSink
+{
+public:
+    void publish(const OrderEvent&) noexcept override
+    { }
+};
+
+// formats events synchronously in the caller's thread - how buy() used to work
+export class StreamOrderSink : public OrderSink
+{
+    std::ostream& out_;
+
+public:
+    explicit StreamOrderSink(std::ostream& out)
+        : out_{out}
+    { }
+
+    void publish(const OrderEvent& event) noexcept override
+    {
+        print(out_, event);
+    }
+};
+
+// bounded lock-free queue (D. Vyukov's sequence-per-cell design) - many producers, single consumer
+template <typename T>
+class RingBuffer
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0; // touched only by the consumer
+
+public:
+    explicit RingBuffer(size_t capacity)
+        : cells_{std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))}
+        , mask_{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1}
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // returns false when the queue is full
+    bool try_push(const T& value)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false; // cell still holds an event from the previous lap
+            else
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false when the queue is empty
+    bool try_pop(T& value)
+    {
+        Cell& cell = cells_[dequeue_pos_ & mask_];
+
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+            return false;
+
+        value = cell.value;
+        cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+    // number of push operations started so far
+    size_t pushed() const
+    {
+        return enqueue_pos_.load(std::memory_order_acquire);
+    }
+};
+
+// publish() only copies the event into a ring buffer - a background thread formats & writes it
+export class AsyncOrderSink : public OrderSink
+{
+    std::ostream& out_;
+    RingBuffer<OrderEvent> events_;
+    alignas(64) std::atomic<size_t> published_{0}; // bumped after every push
+    std::atomic<bool> is_waiting_{false}; // the formatter thread sleeps on an empty queue - publish() has to wake it
+    alignas(64) std::atomic<size_t> written_{0};
+    std::atomic<bool> is_started_{false};
+    std::mutex mtx_; // guards starting the formatter thread & both sleeps below
+    std::condition_variable events_published_; // wakes the formatter thread
+    std::condition_variable events_written_; // wakes flush()
+    std::jthread formatter_; // declared last - stopped & joined before the queue is destroyed
+
+    void start();
+    void wake_formatter();
+    void format_events(std::stop_token stop);
+
+public:
+    explicit AsyncOrderSink(std::ostream& out, size_t capacity = 16 * 1024)
+        : out_{out}
+        , events_{capacity}
+    { }
+
+    ~AsyncOrderSink() override; // defined below the class - the vtable is emitted with it
+
+    void publish(const OrderEvent& event) noexcept override;
+
+    // blocks until every event published so far has been written
+    void flush();
+};
+
+AsyncOrderSink::~AsyncOrderSink()
+{
+    if (!formatter_.joinable())
+        return;
+
+    formatter_.request_stop();
+    wake_formatter(); // it drains the queue & returns
+    formatter_.join();
+}
+
+// asynchronous sink writing to std::cout - used by Customer unless another sink is given
+export AsyncOrderSink& default_order_sink();
+
+// running sum with Neumaier's compensation term - error stays ~1 ulp for millions of small addends
+class CompensatedSum
+{
+    double sum_ = 0.0;
+    double compensation_ = 0.0;
+
+public:
+    void add(double value)
+    {
+        const double sum = sum_ + value;
+
+        if (std::abs(sum_) >= std::abs(value))
+            compensation_ += (sum_ - sum) + value; // low-order bits of value lost in sum
+        else
+            compensation_ += (value - sum) + sum_; // low-order bits of sum_ lost in sum
+
+        sum_ = sum;
+    }
+
+    // merges a sum computed separately - e.g. by another thread
+    void add(const CompensatedSum& other)
+    {
+        add(other.sum_);
+        add(other.compensation_);
+    }
+
+    double value() const
+    {
+        return sum_ + compensation_;
+    }
+};
+
+// struct-of-arrays storage of orders - price scans touch only counts_ & prices_
+class OrderStore
+{
+    std::vector<unsigned int> counts_;
+    std::vector<double> prices_;
+    std::vector<uint32_t> name_ids_;
+
+    NameTable names_;
+
+    CompensatedSum total_price_; // maintained by push_back()
+
+    void parse_lines(std::string_view lines);
+
+public:
+    uint32_t intern(std::string_view name)
+    {
+        return names_.intern(name);
+    }
+
+    void push_back(const Order& order)
+    {
+        counts_.push_back(order.count);
+        prices_.push_back(order.price);
+        name_ids_.push_back(order.name_id);
+
+        total_price_.add(order.count * order.price);
+    }
+
+    void reserve(size_t additional_orders)
+    {
+        counts_.reserve(size() + additional_orders);
+        prices_.reserve(size() + additional_orders);
+        name_ids_.reserve(size() + additional_orders);
+    }
+
+    // parses "count,name,price" lines - throws std::invalid_argument for a malformed line & then leaves orders unchanged
+    void append_lines(std::string_view lines);
+
+    // appends orders of other - each distinct name is looked up in this table once
+    void append(const OrderStore& other);
+
+    size_t size() const
+    {
+        return counts_.size();
+    }
+
+    bool empty() const
+    {
+        return counts_.empty();
+    }
+
+    unsigned int count(size_t index) const
+    {
+        return counts_[index];
+    }
+
+    // resolved only when needed - stored orders keep just the id
+    std::string_view name(size_t index) const
+    {
+        return names_[name_ids_[index]];
+    }
+
+    double price(size_t index) const
+    {
+        return prices_[index];
+    }
+
+    // O(1) - running total
+    double total_price() const
+    {
+        return total_price_.value();
+    }
+
+    // O(n) - sums all stored orders again
+    double scan_total_price() const;
+
+    size_t memory_usage() const;
+};
 
 export class Customer
 {
 private:
     std::string name_;
-    std::vector<Order> orders_;
+    OrderStore orders_;
+    OrderSink* sink_;
 
 public:
-    Customer(std::string name)
+    Customer(std::string name, OrderSink& sink = default_order_sink())
         : name_{std::move(name)}
+        , sink_{&sink}
     { }
 
-    void buy(std::string order_name, double price)
+    void buy(std::string_view order_name, double price)
     {
-        Order order{1, std::move(order_name), price};
-
-        ::print(order);
-        
-        orders_.push_back(std::move(order));
+        buy(1, order_name, price);
     }
 
-    void buy(unsigned int count, std::string order_name, double price)
+    void buy(unsigned int count, std::string_view order_name, double price)
     {
-        Order order{count, std::move(order_name), price};
-
-        ::print(order);
+        sink_->publish(OrderEvent{name_, count, order_name, price});
 
-        orders_.push_back(std::move(order));
+        orders_.push_back(Order{count, orders_.intern(order_name), price});
     }
 
     double total_price() const;
     double average_price() const;
     void print() const;
+
+    // full rescan of orders - reference for total_price()
+    double scan_total_price() const
+    {
+        return orders_.scan_total_price();
+    }
+
+    size_t order_count() const
+    {
+        return orders_.size();
+    }
+
+    // bytes allocated for stored orders
+    size_t memory_usage() const
+    {
+        return orders_.memory_usage();
+    }
+
+    // bulk load of order history from "count,name,price" lines - orders are not published to the sink
+    void buy_many(std::string_view order_lines, unsigned int num_threads = 1);
+
+    // memory-maps the file & calls buy_many()
+    void load_orders(const std::string& file_name, unsigned int num_threads = 1);
+};
+
+export struct CustomerTotals
+{
+    uint64_t order_count = 0;
+    double total_price = 0.0;
+
+    double average_price() const
+    {
+        return order_count == 0 ? 0.0 : total_price / order_count;
+    }
+};
+
+// Customer guarded by its own mutex - totals are published through a seqlock, so readers never block
+export class SharedCustomer
+{
+    mutable std::mutex mtx_;
+    Customer customer_;
+
+    std::atomic<uint64_t> version_{0}; // odd while totals are being updated
+    std::atomic<uint64_t> order_count_{0};
+    std::atomic<double> total_price_{0.0};
+
+public:
+    SharedCustomer(std::string name, OrderSink& sink)
+        : customer_{std::move(name), sink}
+    { }
+
+    void buy(unsigned int count, std::string_view order_name, double price);
+
+    // lock-free - retries only while a buy() of this customer is publishing new totals
+    CustomerTotals totals() const;
+
+    // exclusive access for anything beyond the totals - e.g. Customer::print()
+    template <typename F>
+    decltype(auto) with_customer(F&& f) const
+    {
+        std::lock_guard lk{mtx_};
+        return std::forward<F>(f)(std::as_const(customer_));
+    }
+};
+
+// customers keyed by name & spread over independently locked shards
+export class CustomerRegistry
+{
+    struct NameHash
+    {
+        using is_transparent = void; // lookup with std::string_view - no std::string per buy()
+
+        size_t operator()(std::string_view name) const
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    struct alignas(64) Shard // own cache line - locking one shard does not slow down its neighbours
+    {
+        mutable std::shared_mutex mtx;
+        std::unordered_map<std::string, std::unique_ptr<SharedCustomer>, NameHash, std::equal_to<>> customers;
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_mask_;
+    OrderSink* sink_;
+
+    Shard& shard_for(std::string_view name) const
+    {
+        return shards_[NameHash{}(name) & shard_mask_];
+    }
+
+public:
+    // both defined in eshop_registry_impl.cpp - gcc 12 does not emit the map destructor for importers of inline ones
+    explicit CustomerRegistry(size_t shard_count = 64, OrderSink& sink = default_order_sink());
+    ~CustomerRegistry();
+
+    // creates the customer on first use - the reference stays valid for the lifetime of the registry
+    SharedCustomer& customer(std::string_view name);
+
+    // nullptr for an unknown customer
+    const SharedCustomer* find(std::string_view name) const;
+
+    void buy(std::string_view customer_name, unsigned int count, std::string_view order_name, double price)
+    {
+        customer(customer_name).buy(count, order_name, price);
+    }
+
+    size_t size() const;
 };
\ No newline at end of file
@@ -1,24 +1,141 @@
 module EShop;
 
-import <iostream>;
-import <vector>;
+import "eshop_std.hpp";
 
-void print(const Order& order)
+// one table per publishing thread - buy() locks only while its thread interns its first long name
+// (tables are never freed - queued events may outlive their thread & static sinks drain at exit)
+std::string_view intern_name(std::string_view name)
 {
-    std::cout << "Order{count: " << order.count 
-              << ", name: " << order.name
-              << ", price: " << order.price << "$}\n";
+    static std::mutex mtx;
+    static auto& tables = *new std::vector<std::unique_ptr<NameTable>>;
+    thread_local NameTable* names = nullptr;
+
+    if (!names)
+    {
+        std::lock_guard lk{mtx};
+        names = tables.emplace_back(std::make_unique<NameTable>()).get();
+    }
+
+    return (*names)[names->intern(name)];
+}
+
+void print(std::ostream& out, const OrderEvent& event)
+{
+    out << "Order{count: " << event.count 
+        << ", name: " << event.order_name.view()
+        << ", price: " << event.price << "$}\n";
+}
+
+// same text as print() - std::to_chars with 6 significant digits matches the default ostream formatting
+void append(std::string& text, const OrderEvent& event)
+{
+    char number[32];
+
+    text += "Order{count: ";
+    text.append(number, std::to_chars(number, number + sizeof(number), static_cast<double>(event.count), std::chars_format::fixed).ptr); // integral overload needs a digit table gcc 12 does not emit from header units
+    text += ", name: ";
+    text += event.order_name.view();
+    text += ", price: ";
+    text.append(number, std::to_chars(number, number + sizeof(number), event.price, std::chars_format::general, 6).ptr);
+    text += "$}\n";
+}
+
+void AsyncOrderSink::start()
+{
+    std::lock_guard lk{mtx_};
+
+    if (!formatter_.joinable())
+    {
+        formatter_ = std::jthread{[this](std::stop_token stop) { format_events(stop); }};
+        is_started_.store(true, std::memory_order_release);
+    }
+}
+
+void AsyncOrderSink::wake_formatter()
+{
+    // seq_cst pairs with the store to is_waiting_ in format_events() - either the formatter thread sees the new count
+    // or this thread sees it waiting
+    published_.fetch_add(1, std::memory_order_seq_cst);
+
+    if (is_waiting_.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard lk{mtx_};
+        events_published_.notify_one();
+    }
+}
+
+void AsyncOrderSink::publish(const OrderEvent& event) noexcept
+{
+    if (!is_started_.load(std::memory_order_acquire))
+        start(); // the first event starts the formatter thread - a sink that is never used costs no thread
+
+    while (!events_.try_push(event))
+        std::this_thread::yield(); // queue full - apply back-pressure instead of dropping the event
+
+    wake_formatter(); // no lock unless the formatter thread is asleep
+}
+
+void AsyncOrderSink::format_events(std::stop_token stop)
+{
+    std::string text;
+    OrderEvent event;
+
+    while (true)
+    {
+        const size_t published = published_.load(std::memory_order_acquire); // loaded before draining - a later publish() ends the sleep below
+        const bool is_stopping = stop.stop_requested(); // checked before draining - nothing published earlier is lost
+
+        size_t count = 0;
+        while (count < 1024 && events_.try_pop(event))
+        {
+            append(text, event);
+            ++count;
+        }
+
+        if (count > 0)
+        {
+            out_.write(text.data(), text.size()).flush(); // one write per batch of events
+            text.clear();
+            written_.fetch_add(count, std::memory_order_release);
+
+            std::lock_guard lk{mtx_};
+            events_written_.notify_all();
+        }
+        else if (is_stopping)
+            return;
+        else
+        {
+            std::unique_lock lk{mtx_};
+            is_waiting_.store(true, std::memory_order_seq_cst);
+            events_published_.wait(lk, [&] { return published_.load(std::memory_order_seq_cst) != published; });
+            is_waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncOrderSink::flush()
+{
+    const size_t published = events_.pushed();
+
+    std::unique_lock lk{mtx_};
+    events_written_.wait(lk, [&] { return written_.load(std::memory_order_acquire) >= published; });
+}
+
+AsyncOrderSink& default_order_sink()
+{
+    static AsyncOrderSink sink{std::cout};
+    return sink;
 }
 
 void Customer::print() const
 {
     std::cout << name_ << ":\n";
 
-    for(const auto& order : orders_)
+    for(size_t i = 0; i < orders_.size(); ++i)
     {
-        std::cout << order.count
-            << " - " << order.name
-            << " - " << order.price << "$\n";
+        std::cout << orders_.count(i)
+            << " - " << orders_.name(i)
+            << " - " << orders_.price(i) << "$\n";
     }
 
     std::cout << "------------------------\n"; 
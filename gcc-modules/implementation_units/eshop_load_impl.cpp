@@ -0,0 +1,258 @@
+module; // global module fragment - POSIX headers are not importable
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+module EShop; // implementation unit of module EShop
+
+import "eshop_std.hpp";
+
+namespace
+{
+    // read-only view of a whole file mapped into memory
+    class MappedFile
+    {
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+
+    public:
+        explicit MappedFile(const std::string& file_name)
+        {
+            const int fd = ::open(file_name.c_str(), O_RDONLY);
+            if (fd == -1)
+                throw std::system_error{errno, std::generic_category(), file_name};
+
+            struct stat info;
+            if (::fstat(fd, &info) == -1)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error{error, std::generic_category(), file_name};
+            }
+
+            size_ = static_cast<size_t>(info.st_size);
+
+            if (size_ > 0)
+            {
+                // MAP_POPULATE - the whole file is read anyway, so pre-faulting saves a page fault per 4 KiB
+                void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    const int error = errno;
+                    ::close(fd);
+                    throw std::system_error{error, std::generic_category(), file_name};
+                }
+
+                data_ = static_cast<const char*>(data);
+            }
+
+            ::close(fd); // mapping stays valid
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            if (data_)
+                ::munmap(const_cast<char*>(data_), size_);
+        }
+
+        std::string_view text() const
+        {
+            return {data_, size_};
+        }
+    };
+
+    // plain decimals like "159.90" have an exact mantissa & power of 10 - a single division rounds
+    // them correctly, same as std::from_chars, which handles everything else (exponents, long mantissas)
+    bool parse_price(const char* first, const char* last, double& price)
+    {
+        constexpr double powers_of_10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int fraction_digits = 0;
+        bool has_point = false;
+        const char* it = first;
+
+        for (; it != last && digits <= 15; ++it)
+        {
+            if (*it >= '0' && *it <= '9')
+            {
+                mantissa = mantissa * 10 + (*it - '0');
+                ++digits;
+                fraction_digits += has_point;
+            }
+            else if (*it == '.' && !has_point)
+                has_point = true;
+            else
+                break;
+        }
+
+        if (it == last && digits > 0 && digits <= 15)
+        {
+            price = static_cast<double>(mantissa) / powers_of_10[fraction_digits];
+            return true;
+        }
+
+        auto [end, error] = std::from_chars(first, last, price);
+        return error == std::errc{} && end == last;
+    }
+
+    [[noreturn]] void throw_invalid_line(std::string_view line)
+    {
+        throw std::invalid_argument{"invalid order line: '" + std::string{line} + "'"};
+    }
+
+    // splits text into parts of similar size - every part ends after a '\n' (or at the end of text)
+    std::vector<std::string_view> split_lines(std::string_view text, size_t parts)
+    {
+        std::vector<std::string_view> chunks;
+
+        while (!text.empty())
+        {
+            size_t end = text.size();
+
+            if (parts > 1)
+            {
+                const size_t newline = text.find('\n', text.size() / parts);
+                end = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+
+            chunks.push_back(text.substr(0, end));
+            text.remove_prefix(end);
+            --parts;
+        }
+
+        return chunks;
+    }
+}
+
+void OrderStore::append_lines(std::string_view lines)
+{
+    const size_t size_before = size();
+    const CompensatedSum total_price_before = total_price_;
+
+    // line count estimated from the first 64 KiB - counting every '\n' would cost an extra pass over the text
+    const size_t sample_size = std::min<size_t>(lines.size(), 64 * 1024);
+    const size_t sample_lines = std::count(lines.begin(), lines.begin() + sample_size, '\n') + 1;
+    reserve(sample_size == 0 ? 0 : lines.size() / sample_size * sample_lines + sample_lines);
+
+    try
+    {
+        parse_lines(lines);
+    }
+    catch (...)
+    {
+        // strong guarantee for stored orders - names interned so far are kept
+        counts_.resize(size_before);
+        prices_.resize(size_before);
+        name_ids_.resize(size_before);
+        total_price_ = total_price_before;
+        throw;
+    }
+}
+
+void OrderStore::parse_lines(std::string_view lines)
+{
+    while (!lines.empty())
+    {
+        const size_t line_end = lines.find('\n');
+        std::string_view line = lines.substr(0, line_end);
+        lines.remove_prefix(line_end == std::string_view::npos ? lines.size() : line_end + 1);
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        if (line.empty())
+            continue;
+
+        // the name may contain commas - count ends at the first one, price starts after the last one
+        const size_t name_begin = line.find(',') + 1;
+        const size_t name_end = line.rfind(',');
+
+        if (name_end == std::string_view::npos || name_begin > name_end)
+            throw_invalid_line(line);
+
+        const char* const first = line.data();
+        const char* const last = line.data() + line.size();
+
+        unsigned int count;
+        if (auto [end, error] = std::from_chars(first, first + name_begin - 1, count); error != std::errc{} || end != first + name_begin - 1)
+            throw_invalid_line(line);
+
+        double price;
+        if (!parse_price(first + name_end + 1, last, price))
+            throw_invalid_line(line);
+
+        push_back(Order{count, intern(line.substr(name_begin, name_end - name_begin)), price});
+    }
+}
+
+void OrderStore::append(const OrderStore& other)
+{
+    std::vector<uint32_t> ids(other.names_.size());
+    for (uint32_t id = 0; id < ids.size(); ++id)
+        ids[id] = intern(other.names_[id]);
+
+    reserve(other.size());
+
+    counts_.insert(counts_.end(), other.counts_.begin(), other.counts_.end());
+    prices_.insert(prices_.end(), other.prices_.begin(), other.prices_.end());
+    for (uint32_t name_id : other.name_ids_)
+        name_ids_.push_back(ids[name_id]);
+
+    total_price_.add(other.total_price_);
+}
+
+void Customer::buy_many(std::string_view order_lines, unsigned int num_threads)
+{
+    if (num_threads <= 1)
+    {
+        orders_.append_lines(order_lines); // parsed straight into the customer's store
+        return;
+    }
+
+    const auto chunks = split_lines(order_lines, num_threads);
+
+    std::vector<OrderStore> parsed_chunks(chunks.size());
+    std::vector<std::exception_ptr> errors(chunks.size());
+
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            threads.emplace_back([&, i] {
+                try
+                {
+                    parsed_chunks[i].append_lines(chunks[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+    } // joins all threads
+
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error); // nothing was added to orders_ yet
+
+    size_t total_size = 0;
+    for (const auto& chunk : parsed_chunks)
+        total_size += chunk.size();
+
+    orders_.reserve(total_size);
+    for (const auto& chunk : parsed_chunks)
+        orders_.append(chunk); // in file order
+}
+
+void Customer::load_orders(const std::string& file_name, unsigned int num_threads)
+{
+    const MappedFile file{file_name};
+    buy_many(file.text(), num_threads);
+}
@@ -1,15 +1,44 @@
 module EShop; // implementation unit of module EShop
 
-import <vector>;
+import "eshop_std.hpp";
 
-double Customer::total_price() const
+// contiguous scan with independent partial sums - no loop-carried dependency on a single accumulator
+double OrderStore::scan_total_price() const
+{
+    const size_t size = counts_.size();
+    double partial_totals[4] = {0.0, 0.0, 0.0, 0.0};
+
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+        for (size_t lane = 0; lane < 4; ++lane)
+            partial_totals[lane] += counts_[i + lane] * prices_[i + lane];
+
+    for (; i < size; ++i)
+        partial_totals[0] += counts_[i] * prices_[i];
+
+    return (partial_totals[0] + partial_totals[1]) + (partial_totals[2] + partial_totals[3]);
+}
+
+// arena blocks + id index + hash slots
+size_t NameTable::memory_usage() const
 {
-    double total = 0.0;
-    
-    for(const auto& order : orders_)
-        total += order.count * order.price;
+    return arena_size_
+        + blocks_.capacity() * sizeof(std::unique_ptr<char[]>)
+        + names_.capacity() * sizeof(std::string_view)
+        + slots_.capacity() * sizeof(Slot);
+}
 
-    return total;
+size_t OrderStore::memory_usage() const
+{
+    return counts_.capacity() * sizeof(unsigned int)
+        + prices_.capacity() * sizeof(double)
+        + name_ids_.capacity() * sizeof(uint32_t)
+        + names_.memory_usage();
+}
+
+double Customer::total_price() const
+{
+    return orders_.total_price();
 }
 
 double Customer::average_price() const
@@ -18,4 +47,4 @@ double Customer::average_price() const
         return 0.0;
 
     return total_price() / orders_.size();
-}
\ No newline at end of file
+}
@@ -0,0 +1,80 @@
+module EShop; // implementation unit of module EShop
+
+import "eshop_std.hpp";
+
+void SharedCustomer::buy(unsigned int count, std::string_view order_name, double price)
+{
+    std::lock_guard lk{mtx_};
+
+    customer_.buy(count, order_name, price);
+
+    // single writer (mtx_ is held) - relaxed stores are ordered by the fences
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    order_count_.store(customer_.order_count(), std::memory_order_relaxed);
+    total_price_.store(customer_.total_price(), std::memory_order_relaxed);
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+CustomerTotals SharedCustomer::totals() const
+{
+    while (true)
+    {
+        const uint64_t version = version_.load(std::memory_order_acquire);
+
+        CustomerTotals totals{order_count_.load(std::memory_order_relaxed), total_price_.load(std::memory_order_relaxed)};
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version % 2 == 0 && version == version_.load(std::memory_order_relaxed))
+            return totals;
+    }
+}
+
+CustomerRegistry::CustomerRegistry(size_t shard_count, OrderSink& sink)
+    : shards_{std::make_unique<Shard[]>(std::bit_ceil(std::max<size_t>(shard_count, 1)))}
+    , shard_mask_{std::bit_ceil(std::max<size_t>(shard_count, 1)) - 1}
+    , sink_{&sink}
+{ }
+
+CustomerRegistry::~CustomerRegistry() = default;
+
+SharedCustomer& CustomerRegistry::customer(std::string_view name)
+{
+    Shard& shard = shard_for(name);
+
+    {
+        std::shared_lock lk{shard.mtx}; // known customers - shared lock only
+        if (auto it = shard.customers.find(name); it != shard.customers.end())
+            return *it->second;
+    }
+
+    std::unique_lock lk{shard.mtx};
+
+    auto it = shard.customers.find(name); // another thread may have added it in the meantime
+    if (it == shard.customers.end())
+        it = shard.customers.emplace(std::string{name}, std::make_unique<SharedCustomer>(std::string{name}, *sink_)).first;
+
+    return *it->second;
+}
+
+const SharedCustomer* CustomerRegistry::find(std::string_view name) const
+{
+    const Shard& shard = shard_for(name);
+
+    std::shared_lock lk{shard.mtx};
+    auto it = shard.customers.find(name);
+    return it != shard.customers.end() ? it->second.get() : nullptr;
+}
+
+size_t CustomerRegistry::size() const
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i <= shard_mask_; ++i)
+    {
+        std::shared_lock lk{shards_[i].mtx};
+        count += shards_[i].customers.size();
+    }
+
+    return count;
+}
@@ -1,6 +1,39 @@
 import EShop;
 
-import <iostream>;
+import "eshop_std.hpp";
+
+// discards everything written to it - sinks still format their output
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		return c;
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize count) override
+	{
+		return count;
+	}
+};
+
+// layout of orders before the struct-of-arrays store - reference for the benchmark
+struct LegacyOrder
+{
+	unsigned int count;
+	std::string name;
+	double price;
+};
+
+template <typename F>
+auto measure(F&& f)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto result = f();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::pair{result, std::chrono::duration_cast<std::chrono::microseconds>(end - start)};
+}
 
 int main()
 {
@@ -11,9 +44,198 @@ int main()
 	c1.buy("wine", 159.90);
 	c1.buy(2, "wine glass", 9.20);
 
+	default_order_sink().flush(); // orders are printed by a background thread
+
 	std::cout << "\n------------\n";
 		
 	c1.print();
 
 	std::cout << "Average: " << c1.average_price() << '\n';
-}
\ No newline at end of file
+
+	// benchmark: struct-of-arrays Customer vs. std::vector<LegacyOrder>
+	auto to_text = [](size_t number) { // std::to_string() needs a digit table gcc 12 does not emit from header units
+		char text[32];
+		return std::string{text, std::to_chars(text, text + sizeof(text), static_cast<double>(number), std::chars_format::fixed).ptr};
+	};
+
+	std::vector<std::string> catalogue = {"wine", "wine glass", "cheese platter", "sparkling water bottle", "corkscrew",
+		"hand-painted crystal wine glasses - set of six"}; // longer than an inline ShortString - interned by the sinks
+	for (int i = 0; i < 3'000; ++i) // a few thousand products repeated across all orders
+		catalogue.push_back("product #" + to_text(i) + " - gift edition");
+	const size_t order_count = 1'000'000;
+
+	NullOrderSink null_sink;
+	Customer c2{"Anna Nowak", null_sink};
+	std::vector<LegacyOrder> legacy_orders;
+
+	for (size_t i = 0; i < order_count; ++i)
+	{
+		const auto& name = catalogue[i % catalogue.size()];
+		const double price = 1.0 + i % 100;
+		c2.buy(i % 3 + 1, name, price);
+		legacy_orders.push_back(LegacyOrder{static_cast<unsigned int>(i % 3 + 1), name, price});
+	}
+
+	size_t legacy_bytes = legacy_orders.capacity() * sizeof(LegacyOrder);
+	for (const auto& order : legacy_orders)
+		if (order.name.capacity() > 15)
+			legacy_bytes += order.name.capacity() + 1;
+
+	std::cout << "\nMemory per order - vector<Order> with std::string names: " << double(legacy_bytes) / order_count
+		<< " B, struct-of-arrays with interned names: " << double(c2.memory_usage()) / order_count << " B\n";
+
+	auto [legacy_total, legacy_time] = measure([&] {
+		double total = 0.0;
+		for (const auto& order : legacy_orders)
+			total += order.count * order.price;
+		return total;
+	});
+	std::cout << "total_price - vector<Order>: " << legacy_total << " in " << legacy_time.count() << " us\n";
+
+	auto [scan_total, scan_time] = measure([&] { return c2.scan_total_price(); });
+	std::cout << "total_price - struct-of-arrays scan: " << scan_total << " in " << scan_time.count() << " us\n";
+
+	auto [total, time] = measure([&] { return c2.total_price(); });
+	std::cout << "total_price - running total: " << total << " in " << time.count() << " us\n";
+
+	// stress test: running totals vs. full rescan for millions of small prices
+	Customer c3{"Stress Test", null_sink};
+	for (size_t i = 0; i < 5'000'000; ++i)
+	{
+		c3.buy(1, "candy", 0.01 * (1 + i % 99));
+
+		if (i % 500'000 == 0)
+		{
+			const double running = c3.total_price();
+			const double rescan = c3.scan_total_price();
+			if (std::abs(running - rescan) > 1e-9 * rescan)
+			{
+				std::cout << "Running total " << running << " differs from rescan " << rescan << " after " << i + 1 << " orders\n";
+				return 1;
+			}
+		}
+	}
+	std::cout.precision(17);
+	std::cout << "Stress test - running total: " << c3.total_price() << ", rescan: " << c3.scan_total_price()
+		<< ", average: " << c3.average_price() << "\n";
+	std::cout.precision(6);
+
+	// benchmark: bulk loading of a memory-mapped order file
+	const std::string orders_file = "eshop_orders.csv"; // in the working directory - std::filesystem::path from a gcc 12 header unit has the wrong ABI
+	const size_t file_order_count = 10'000'000;
+	size_t file_size = 0;
+	{
+		std::ofstream file{orders_file, std::ios::binary};
+		std::string lines;
+		for (size_t i = 0; i < file_order_count; ++i)
+		{
+			lines += to_text(i % 3 + 1) + ',' + catalogue[i * 7919 % catalogue.size()] + ',' + to_text(1 + i % 100) + ".99\n";
+			if (lines.size() > (1 << 20))
+			{
+				file << lines;
+				file_size += lines.size();
+				lines.clear();
+			}
+		}
+		file << lines;
+		file_size += lines.size();
+	}
+	const double file_mb = file_size / 1e6;
+
+	for (unsigned int num_threads : std::array{1u, std::max(2u, std::thread::hardware_concurrency())})
+	{
+		Customer customer{"Bulk Loader", null_sink};
+		auto [loaded, load_time] = measure([&] {
+			customer.load_orders(orders_file, num_threads);
+			return customer.scan_total_price();
+		});
+		std::cout << "load_orders with " << num_threads << " thread(s): " << file_mb << " MB in " << load_time.count() << " us - "
+			<< file_mb / std::max<long long>(1, load_time.count()) * 1e6 / 1e3 << " GB/s (total: " << loaded
+			<< ", running total: " << customer.total_price() << ")\n";
+	}
+	std::remove(orders_file.c_str());
+
+	// benchmark: concurrent buy() for many customers - one lock vs. sharded registry
+	std::vector<std::string> customer_names;
+	for (int i = 0; i < 1'000; ++i)
+		customer_names.push_back("customer #" + to_text(i));
+
+	const size_t registry_order_count = 2'000'000;
+
+	std::cout << "\n";
+	for (size_t shard_count : std::array<size_t, 2>{1, 64})
+	{
+		for (unsigned int num_threads = 1; num_threads <= 64; num_threads *= 2)
+		{
+			CustomerRegistry registry{shard_count, null_sink};
+
+			auto [total, time] = measure([&] {
+				{
+					std::vector<std::jthread> threads;
+					for (unsigned int t = 0; t < num_threads; ++t)
+					{
+						threads.emplace_back([&, t] {
+							for (size_t i = t; i < registry_order_count; i += num_threads)
+								registry.buy(customer_names[i * 7919 % customer_names.size()], i % 3 + 1,
+											 catalogue[i % catalogue.size()], 1.0 + i % 100);
+						});
+					}
+				}
+
+				double total = 0.0;
+				for (const auto& name : customer_names)
+					total += registry.find(name)->totals().total_price; // lock-free read of the aggregates
+				return total;
+			});
+
+			std::cout << "CustomerRegistry with " << shard_count << " shard(s), " << num_threads << " thread(s): "
+				<< registry_order_count * 1'000'000.0 / std::max<long long>(1, time.count()) << " orders/s (total: " << total << ")\n";
+		}
+	}
+
+	// benchmark: orders/s of buy() with each order sink
+	NullBuffer null_buffer;
+	std::ostream null_stream{&null_buffer};
+
+	auto buy_orders = [&](OrderSink& sink) {
+		Customer customer{"Benchmark", sink};
+		for (size_t i = 0; i < order_count; ++i)
+			customer.buy(i % 3 + 1, catalogue[i % catalogue.size()], 1.0 + i % 100);
+		return customer.total_price();
+	};
+
+	auto report = [&](const char* sink_name, std::chrono::microseconds time) {
+		std::cout << "buy() with " << sink_name << ": " << order_count * 1'000'000.0 / std::max<long long>(1, time.count())
+			<< " orders/s (" << time.count() << " us)\n";
+	};
+
+	std::cout << "\n";
+
+	auto [null_total, null_time] = measure([&] { return buy_orders(null_sink); });
+	report("NullOrderSink", null_time);
+
+	StreamOrderSink stream_sink{null_stream};
+	auto [stream_total, stream_time] = measure([&] { return buy_orders(stream_sink); });
+	report("StreamOrderSink", stream_time);
+
+	AsyncOrderSink async_sink{null_stream};
+	auto [async_total, async_time] = measure([&] { return buy_orders(async_sink); });
+	report("AsyncOrderSink", async_time);
+
+	auto [flushed, flush_time] = measure([&] { async_sink.flush(); return true; });
+	std::cout << "AsyncOrderSink - formatter thread finished " << flush_time.count() << " us after the last buy()\n";
+
+	// names over ShortString's 39 chars - every event looks its name up in the thread's table of interned names
+	std::vector<std::string> long_names;
+	for (int i = 0; i < 1'000; ++i)
+		long_names.push_back("hand-painted crystal wine glass #" + to_text(i) + " - gift edition");
+
+	auto [long_total, long_time] = measure([&] {
+		Customer customer{"Benchmark", async_sink};
+		for (size_t i = 0; i < order_count; ++i)
+			customer.buy(i % 3 + 1, long_names[i % long_names.size()], 1.0 + i % 100);
+		return customer.total_price();
+	});
+	report("AsyncOrderSink & names over 39 chars", long_time);
+	async_sink.flush();
+}
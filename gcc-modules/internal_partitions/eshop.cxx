@@ -1,5 +1,6 @@
 export module EShop;  // module declaration
 
 import :Order;  // import internal partition Order
+export import :Events; // order events & sinks used by Customer
 export import :Customer; // export imported module partition Customer
 
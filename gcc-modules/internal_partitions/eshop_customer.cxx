@@ -1,36 +1,32 @@
 export module EShop:Customer;
 
 import :Order; // import partition module
+import :Events;
 
-import <string>;
-import <vector>;
-import <iostream>;
+import "eshop_std.hpp";
 
 namespace std _GLIBCXX_VISIBILITY(default){} // Fix for gcc 12.2 & import <vector> or any std container
 
+// members defined in eshop_price_impl.cpp - gcc 12 miscompiles std containers used both here & in importers
 export class Customer
 {
 private:
     std::string name_;
     std::vector<Order> orders_;
+    NameTable order_names_;
+    OrderSink* sink_;
 
 public:
-    Customer(std::string name)
-        : name_{std::move(name)}
-    {}
+    Customer(std::string name, OrderSink& sink = default_order_sink());
+    ~Customer();
 
-    void buy(std::string order_name, double price)
-    {
-        std::cout << name_ << " is buying " << order_name << " for a " << price << "$\n";
-        orders_.push_back(Order{1, std::move(order_name), price});
-    }
-
-    void buy(unsigned int count, std::string order_name, double price)
-    {
-        orders_.push_back(Order{count, std::move(order_name), price});
-    }
+    void buy(std::string_view order_name, double price); // publishes an OrderEvent to the sink
+    void buy(unsigned int count, std::string_view order_name, double price);
 
     double total_price() const;
     double average_price() const;
     void print() const;
+
+    // bytes allocated for stored orders & their names
+    size_t memory_usage() const;
 };
\ No newline at end of file
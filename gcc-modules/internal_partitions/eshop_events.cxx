@@ -0,0 +1,208 @@
+export module EShop:Events; // interface partition - order events & sinks
+
+import "eshop_std.hpp";
+
+namespace std _GLIBCXX_VISIBILITY(default){} // Fix for gcc 12.2 & import <vector> or any std container
+
+std::string_view intern_name(std::string_view name); // not exported - defined in eshop_io_impl.cpp, the view stays valid until exit
+
+// inline copy of a name - longer names are interned once per thread, so events keep a fixed size & publishing never locks
+// (not a template - gcc 12 miscompiles class template members used both in a partition & in importers)
+class ShortString
+{
+    static constexpr size_t capacity = 39;
+
+    char data_[capacity]{};
+    uint8_t size_ = 0;
+    std::string_view long_text_; // set for names that do not fit into data_
+
+public:
+    ShortString() = default;
+
+    ShortString(std::string_view text)
+    {
+        if (text.size() <= capacity)
+        {
+            size_ = static_cast<uint8_t>(text.size());
+            std::copy_n(text.data(), size_, data_);
+        }
+        else
+            long_text_ = intern_name(text);
+    }
+
+    std::string_view view() const
+    {
+        return long_text_.empty() ? std::string_view{data_, size_} : long_text_;
+    }
+};
+
+// trivially copyable & fixed-size - publishing one is a plain copy into the sink's queue
+export struct OrderEvent
+{
+    ShortString customer;
+    ShortString order_name;
+    double price = 0.0;
+
+    OrderEvent() = default;
+
+    OrderEvent(std::string_view customer, std::string_view order_name, double price)
+        : customer{customer}
+        , order_name{order_name}
+        , price{price}
+    { }
+};
+
+void print(std::ostream& out, const OrderEvent& event); // not exported - defined in eshop_io_impl.cpp
+
+// receives an event for every order placed by Customer::buy(order_name, price)
+export class OrderSink
+{
+public:
+    virtual ~OrderSink(); // defined below the class - gcc 12 crashes cloning an inline one & emits the vtable with it
+    virtual void publish(const OrderEvent& event) noexcept = 0;
+};
+
+OrderSink::~OrderSink() = default;
+
+// discards events - for benchmarks
+export class NullOrderSink : public OrderSink
+{
+public:
+    void publish(const OrderEvent&) noexcept override
+    { }
+};
+
+// prints events synchronously in the caller's thread - how buy() used to work
+export class StreamOrderSink : public OrderSink
+{
+    std::ostream& out_;
+
+public:
+    explicit StreamOrderSink(std::ostream& out)
+        : out_{out}
+    { }
+
+    void publish(const OrderEvent& event) noexcept override
+    {
+        print(out_, event);
+    }
+};
+
+// bounded lock-free queue (D. Vyukov's sequence-per-cell design) - many producers, single consumer
+template <typename T>
+class RingBuffer
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0; // touched only by the consumer
+
+public:
+    explicit RingBuffer(size_t capacity)
+        : cells_{std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))}
+        , mask_{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1}
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // returns false when the queue is full
+    bool try_push(const T& value)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false; // cell still holds an event from the previous lap
+            else
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false when the queue is empty
+    bool try_pop(T& value)
+    {
+        Cell& cell = cells_[dequeue_pos_ & mask_];
+
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+            return false;
+
+        value = cell.value;
+        cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+    // number of push operations started so far
+    size_t pushed() const
+    {
+        return enqueue_pos_.load(std::memory_order_acquire);
+    }
+};
+
+// publish() only copies the event into a lock-free ring buffer - a background thread formats & writes it
+// (the same queue as in implementation_units - locks are taken only to start or wake the formatter thread)
+export class AsyncOrderSink : public OrderSink
+{
+    std::ostream& out_;
+    RingBuffer<OrderEvent> events_;
+    alignas(64) std::atomic<size_t> published_{0}; // bumped after every push
+    std::atomic<bool> is_waiting_{false}; // the formatter thread sleeps on an empty queue - publish() has to wake it
+    alignas(64) std::atomic<size_t> written_{0};
+    std::atomic<bool> is_started_{false};
+    std::mutex mtx_; // guards starting the formatter thread & both sleeps below
+    std::condition_variable events_published_; // wakes the formatter thread
+    std::condition_variable events_written_; // wakes flush()
+    std::jthread formatter_; // declared last - stopped & joined before the queue is destroyed
+
+    void start();
+    void wake_formatter();
+    void format_events(std::stop_token stop);
+
+public:
+    explicit AsyncOrderSink(std::ostream& out, size_t capacity = 16 * 1024)
+        : out_{out}
+        , events_{capacity}
+    { }
+
+    ~AsyncOrderSink() override; // defined below the class - the vtable is emitted with it
+
+    void publish(const OrderEvent& event) noexcept override;
+
+    // blocks until every event published so far has been written
+    void flush();
+};
+
+AsyncOrderSink::~AsyncOrderSink()
+{
+    if (!formatter_.joinable())
+        return;
+
+    formatter_.request_stop();
+    wake_formatter(); // it drains the queue & returns
+    formatter_.join();
+}
+
+// asynchronous sink writing to std::cout - used by Customer unless another sink is given
+export AsyncOrderSink& default_order_sink();
\ No newline at end of file
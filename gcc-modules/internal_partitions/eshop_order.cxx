@@ -1,18 +1,149 @@
 module EShop:Order; // interface partition declaration
 
-import <string>;
+import "eshop_std.hpp";
+
+namespace std _GLIBCXX_VISIBILITY(default){} // Fix for gcc 12.2 & import <vector> or any std container
 
 struct Order
 {
     unsigned int count;
-    std::string name;
+    uint32_t name_id; // handle from NameTable
     double price;
-
-    Order(unsigned int count, std::string order_name, double price)
-        : count{count}
-        , name{std::move(order_name)}
-        , price{price}
-    {}
 };
 
-void print(const Order& order);
\ No newline at end of file
+// interned names stored back to back in arena blocks - ids & string_views stay valid for the lifetime of the table
+class NameTable
+{
+    static constexpr size_t first_block_size = 1024;
+    static constexpr size_t max_block_size = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* free_space_ = nullptr;
+    size_t free_size_ = 0;
+    size_t next_block_size_ = first_block_size;
+    size_t arena_size_ = 0;
+
+    std::vector<std::string_view> names_; // indexed by id
+
+    static constexpr uint32_t empty_slot = ~0u;
+
+    struct Slot
+    {
+        uint32_t hash = 0; // upper half of the name's hash - skips most string comparisons
+        uint32_t id = empty_slot;
+    };
+
+    std::vector<Slot> slots_; // open addressing with linear probing - at most half full
+
+    // multiplicative hash reading 8 bytes at a time - the last word overlaps the previous one instead of a byte loop
+    static uint64_t hash(std::string_view name)
+    {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+        uint64_t hash = name.size() * multiplier;
+        uint64_t word = 0;
+
+        if (name.size() >= 8)
+        {
+            for (size_t i = 0; i + 8 < name.size(); i += 8)
+            {
+                std::memcpy(&word, name.data() + i, 8);
+                hash = std::rotl((hash ^ word) * multiplier, 29);
+            }
+
+            std::memcpy(&word, name.data() + name.size() - 8, 8);
+        }
+        else
+        {
+            for (char c : name)
+                word = word << 8 | static_cast<unsigned char>(c);
+        }
+
+        hash = (hash ^ word) * multiplier;
+
+        return hash ^ (hash >> 29);
+    }
+
+    void grow()
+    {
+        slots_.assign(std::max<size_t>(16, 2 * slots_.size()), Slot{});
+
+        const size_t mask = slots_.size() - 1;
+        for (uint32_t id = 0; id < names_.size(); ++id)
+        {
+            const uint64_t name_hash = hash(names_[id]);
+
+            size_t index = name_hash & mask;
+            while (slots_[index].id != empty_slot)
+                index = (index + 1) & mask;
+
+            slots_[index] = Slot{static_cast<uint32_t>(name_hash >> 32), id};
+        }
+    }
+
+    char* allocate(size_t size)
+    {
+        if (size > max_block_size / 4) // long names get a block of their own - the current block stays in use
+        {
+            arena_size_ += size;
+            return blocks_.emplace_back(std::make_unique_for_overwrite<char[]>(size)).get();
+        }
+
+        if (size > free_size_)
+        {
+            free_space_ = blocks_.emplace_back(std::make_unique_for_overwrite<char[]>(next_block_size_)).get();
+            free_size_ = next_block_size_;
+            arena_size_ += next_block_size_;
+            next_block_size_ = std::min(2 * next_block_size_, max_block_size);
+        }
+
+        char* data = free_space_;
+        free_space_ += size;
+        free_size_ -= size;
+        return data;
+    }
+
+public:
+    NameTable() = default;
+    NameTable(const NameTable&) = delete; // views in names_ refer to blocks_
+    NameTable& operator=(const NameTable&) = delete;
+    NameTable(NameTable&&) = default; // blocks are moved, not copied - views stay valid
+    NameTable& operator=(NameTable&&) = default;
+
+    // copies name into the arena only the first time it is seen
+    uint32_t intern(std::string_view name)
+    {
+        if (2 * (names_.size() + 1) > slots_.size())
+            grow();
+
+        const uint64_t name_hash = hash(name);
+        const auto hash_tag = static_cast<uint32_t>(name_hash >> 32);
+        const size_t mask = slots_.size() - 1;
+
+        size_t index = name_hash & mask;
+        for (; slots_[index].id != empty_slot; index = (index + 1) & mask)
+            if (slots_[index].hash == hash_tag && names_[slots_[index].id] == name)
+                return slots_[index].id;
+
+        char* data = allocate(name.size());
+        std::copy_n(name.data(), name.size(), data);
+
+        const auto id = static_cast<uint32_t>(names_.size());
+        names_.push_back(std::string_view{data, name.size()});
+        slots_[index] = Slot{hash_tag, id};
+
+        return id;
+    }
+
+    std::string_view operator[](uint32_t id) const
+    {
+        return names_[id];
+    }
+
+    size_t size() const
+    {
+        return names_.size();
+    }
+
+    size_t memory_usage() const;
+};
\ No newline at end of file
@@ -1,5 +1,34 @@
 module EShop; // implementation unit of module EShop
 
+import "eshop_std.hpp";
+
+// arena blocks + id index + hash slots
+size_t NameTable::memory_usage() const
+{
+    return arena_size_
+        + blocks_.capacity() * sizeof(std::unique_ptr<char[]>)
+        + names_.capacity() * sizeof(std::string_view)
+        + slots_.capacity() * sizeof(Slot);
+}
+
+Customer::Customer(std::string name, OrderSink& sink)
+    : name_{std::move(name)}
+    , sink_{&sink}
+{}
+
+Customer::~Customer() = default;
+
+void Customer::buy(std::string_view order_name, double price)
+{
+    sink_->publish(OrderEvent{name_, order_name, price}); // the sink decides when & where it is printed
+    buy(1, order_name, price);
+}
+
+void Customer::buy(unsigned int count, std::string_view order_name, double price)
+{
+    orders_.push_back(Order{count, order_names_.intern(order_name), price});
+}
+
 double Customer::total_price() const
 {
     double total = 0.0;
@@ -16,4 +45,9 @@ double Customer::average_price() const
         return 0.0;
 
     return total_price() / orders_.size();
+}
+
+size_t Customer::memory_usage() const
+{
+    return orders_.capacity() * sizeof(Order) + order_names_.memory_usage();
 }
\ No newline at end of file
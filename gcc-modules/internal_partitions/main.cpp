@@ -1,6 +1,39 @@
 import EShop;
 
-import <iostream>;
+import "eshop_std.hpp";
+
+// discards everything written to it - sinks still format their output
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		return c;
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize count) override
+	{
+		return count;
+	}
+};
+
+// layout of Order before names were interned - reference for the memory report
+struct LegacyOrder
+{
+	unsigned int count;
+	std::string name;
+	double price;
+};
+
+template <typename F>
+auto measure(F&& f)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto result = f();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::pair{result, std::chrono::duration_cast<std::chrono::microseconds>(end - start)};
+}
 
 int main()
 {
@@ -11,9 +44,76 @@ int main()
 	c1.buy("wine", 159.90);
 	c1.buy(2, "wine glass", 9.20);
 
+	default_order_sink().flush(); // orders are printed by a background thread
+
 	std::cout << "\n------------\n";
 		
 	c1.print();
 
 	std::cout << "Average: " << c1.average_price() << '\n';
+
+	auto to_text = [](size_t number) { // std::to_string() needs a digit table gcc 12 does not emit from header units
+		char text[32];
+		return std::string{text, std::to_chars(text, text + sizeof(text), static_cast<double>(number), std::chars_format::fixed).ptr};
+	};
+
+	std::vector<std::string> catalogue = {"wine", "wine glass", "cheese platter", "sparkling water bottle", "corkscrew",
+		"hand-painted crystal wine glasses - set of six"}; // longer than an inline ShortString - interned by the sinks
+	for (int i = 0; i < 3'000; ++i) // a few thousand products repeated across all orders
+		catalogue.push_back("product #" + to_text(i) + " - gift edition");
+
+	const size_t order_count = 1'000'000;
+
+	// memory: std::string in every order vs. 4-byte ids into the name arena
+	NullOrderSink null_sink;
+	Customer c2{"Anna Nowak", null_sink};
+	std::vector<LegacyOrder> legacy_orders;
+
+	for (size_t i = 0; i < order_count; ++i)
+	{
+		const auto& name = catalogue[i % catalogue.size()];
+		c2.buy(i % 3 + 1, name, 1.0 + i % 100);
+		legacy_orders.push_back(LegacyOrder{static_cast<unsigned int>(i % 3 + 1), name, 1.0 + i % 100});
+	}
+
+	size_t legacy_bytes = legacy_orders.capacity() * sizeof(LegacyOrder);
+	for (const auto& order : legacy_orders)
+		if (order.name.capacity() > 15)
+			legacy_bytes += order.name.capacity() + 1;
+
+	std::cout << "\nMemory per order - std::string names: " << double(legacy_bytes) / order_count
+		<< " B, interned names: " << double(c2.memory_usage()) / order_count << " B\n";
+
+	// benchmark: orders/s of buy() with each order sink
+
+	NullBuffer null_buffer;
+	std::ostream null_stream{&null_buffer};
+
+	auto buy_orders = [&](OrderSink& sink) {
+		Customer customer{"Anna Nowak", sink};
+		for (size_t i = 0; i < order_count; ++i)
+			customer.buy(catalogue[i % catalogue.size()], 1.0 + i % 100); // the overload that publishes an event
+		return customer.total_price();
+	};
+
+	auto report = [&](const char* sink_name, std::chrono::microseconds time) {
+		std::cout << "buy() with " << sink_name << ": " << order_count * 1'000'000.0 / std::max<long long>(1, time.count())
+			<< " orders/s (" << time.count() << " us)\n";
+	};
+
+	std::cout << "\n";
+
+	auto [null_total, null_time] = measure([&] { return buy_orders(null_sink); });
+	report("NullOrderSink", null_time);
+
+	StreamOrderSink stream_sink{null_stream};
+	auto [stream_total, stream_time] = measure([&] { return buy_orders(stream_sink); });
+	report("StreamOrderSink", stream_time);
+
+	AsyncOrderSink async_sink{null_stream};
+	auto [async_total, async_time] = measure([&] { return buy_orders(async_sink); });
+	report("AsyncOrderSink", async_time);
+
+	auto [flushed, flush_time] = measure([&] { async_sink.flush(); return true; });
+	std::cout << "AsyncOrderSink - formatter thread finished " << flush_time.count() << " us after the last buy()\n";
 }
\ No newline at end of file
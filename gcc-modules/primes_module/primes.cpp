@@ -2,48 +2,749 @@ module; // global fragment module
 
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
 #include <limits>
 #include <array>
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <span>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 export module Primes; // declare module Primes
 
-export constexpr bool is_prime(uint32_t n)
+//////////////////////////////////////////////////////////////////////////////
+// Deterministic Miller-Rabin test with Montgomery multiplication (not exported)
+
+namespace Montgomery
 {
-    bool is_prime = true;
+    // high 64 bits of a * b
+    constexpr uint64_t mul_hi(uint64_t a, uint64_t b)
+    {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+#if defined(_MSC_VER)
+        if (!std::is_constant_evaluated())
+            return __umulh(a, b);
+#endif
+        const uint64_t a_lo = a & 0xFFFF'FFFF, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xFFFF'FFFF, b_hi = b >> 32;
+
+        const uint64_t lo_lo = a_lo * b_lo;
+        const uint64_t hi_lo = a_hi * b_lo;
+        const uint64_t lo_hi = a_lo * b_hi;
+        const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFF'FFFF) + lo_hi;
 
-    for (auto i = 2u; i <= std::sqrt(n); ++i)
+        return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+    }
+
+    // arithmetic modulo odd n on numbers in Montgomery form (x * 2^64 mod n)
+    struct Modulus
     {
-        if (n % i == 0)
-            return false;
+        uint64_t n = 1;
+        uint64_t n_inv = 1; // n * n_inv == 1 (mod 2^64)
+        uint64_t one = 0;   // 2^64 mod n
+        uint64_t r2 = 0;    // 2^128 mod n
+
+        Modulus() = default;
+
+        constexpr explicit Modulus(uint64_t n)
+            : n{n}
+            , n_inv{n}
+            , one{(0 - n) % n}
+            , r2{one}
+        {
+            for (int i = 0; i < 5; ++i) // Newton's iteration doubles correct bits: 3, 6, 12, ..., 96
+                n_inv *= 2 - n * n_inv;
+
+            r2 = one >= n - one ? one - (n - one) : one + one; // 2 in Montgomery form
+            for (int i = 0; i < 6; ++i)
+                r2 = mul(r2, r2); // squared 6 times: 2^64 in Montgomery form
+        }
+
+        // a * b * 2^-64 mod n for a, b < n
+        constexpr uint64_t mul(uint64_t a, uint64_t b) const
+        {
+            const uint64_t m = a * b * n_inv; // low 64 bits of a * b - m * n are zero
+            const uint64_t product_hi = mul_hi(a, b);
+            const uint64_t mn_hi = mul_hi(m, n);
+
+            return product_hi >= mn_hi ? product_hi - mn_hi : product_hi + (n - mn_hi);
+        }
+
+        constexpr uint64_t to_montgomery(uint64_t a) const
+        {
+            return mul(a % n, r2);
+        }
+
+        constexpr uint64_t minus_one() const
+        {
+            return n - one;
+        }
+    };
+} // namespace Montgomery
+
+namespace MillerRabin
+{
+    // bases giving a deterministic test for all n < 2^64 (J. Sinclair)
+    inline constexpr std::array<uint64_t, 7> witnesses = {2, 325, 9'375, 28'178, 450'775, 9'780'504, 1'795'265'022};
+
+    // trial division handles every n < 37 * 37
+    inline constexpr std::array<uint64_t, 12> small_primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+    enum class Result
+    {
+        prime,
+        composite,
+        unknown
+    };
+
+    constexpr Result trial_division(uint64_t n)
+    {
+        if (n < 2)
+            return Result::composite;
+
+        for (uint64_t p : small_primes)
+            if (n % p == 0)
+                return n == p ? Result::prime : Result::composite;
+
+        return n < small_primes.back() * small_primes.back() ? Result::prime : Result::unknown;
+    }
+
+    // n - odd, n > 37 * 37
+    constexpr bool is_strong_probable_prime(uint64_t n)
+    {
+        const Montgomery::Modulus mod{n};
+        const int s = std::countr_zero(n - 1);
+        const uint64_t d = (n - 1) >> s;
+
+        for (uint64_t a : witnesses)
+        {
+            if (a % n == 0)
+                continue;
+
+            const uint64_t base = mod.to_montgomery(a);
+            uint64_t x = mod.one;
+            for (int bit = std::bit_width(d) - 1; bit >= 0; --bit)
+            {
+                x = mod.mul(x, x);
+                if ((d >> bit) & 1)
+                    x = mod.mul(x, base);
+            }
+
+            if (x == mod.one || x == mod.minus_one())
+                continue;
+
+            bool is_witness_of_compositeness = true;
+            for (int i = 1; i < s && is_witness_of_compositeness; ++i)
+            {
+                x = mod.mul(x, x);
+                is_witness_of_compositeness = x != mod.minus_one();
+            }
+
+            if (is_witness_of_compositeness)
+                return false;
+        }
+
+        return true;
     }
 
-    return true;
+    // Lanes numbers (odd, > 37 * 37) tested in lockstep - interleaved multiplication chains hide the latency
+    // of 64-bit multiplies
+    template <size_t Lanes>
+    struct Batch
+    {
+        std::array<Montgomery::Modulus, Lanes> mod{};
+        std::array<int, Lanes> s{};
+        std::array<uint64_t, Lanes> d{};
+        int max_bit_width = 0;
+        int max_s = 0;
+
+        explicit Batch(const std::array<uint64_t, Lanes>& n)
+        {
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                mod[lane] = Montgomery::Modulus{n[lane]};
+                s[lane] = std::countr_zero(n[lane] - 1);
+                d[lane] = (n[lane] - 1) >> s[lane];
+                max_bit_width = std::max<int>(max_bit_width, std::bit_width(d[lane]));
+                max_s = std::max(max_s, s[lane]);
+            }
+        }
+
+        // x = a^d in Montgomery form - the test passes if x == 1 or x^(2^i) == -1 for some i < s
+        std::array<bool, Lanes> passes(std::array<uint64_t, Lanes> x) const
+        {
+            std::array<bool, Lanes> is_passed{};
+            for (size_t lane = 0; lane < Lanes; ++lane)
+                is_passed[lane] = x[lane] == mod[lane].one || x[lane] == mod[lane].minus_one();
+
+            for (int i = 1; i < max_s; ++i)
+                for (size_t lane = 0; lane < Lanes; ++lane)
+                {
+                    x[lane] = mod[lane].mul(x[lane], x[lane]);
+                    is_passed[lane] = is_passed[lane] || (i < s[lane] && x[lane] == mod[lane].minus_one());
+                }
+
+            return is_passed;
+        }
+
+        // base 2 - a multiply by 2 is a modular doubling, so every exponent bit costs one multiply
+        std::array<bool, Lanes> is_base_2_strong_probable_prime() const
+        {
+            std::array<uint64_t, Lanes> x{};
+            for (size_t lane = 0; lane < Lanes; ++lane)
+                x[lane] = mod[lane].one;
+
+            for (int bit = max_bit_width - 1; bit >= 0; --bit) // leading zero bits keep x == one
+                for (size_t lane = 0; lane < Lanes; ++lane)
+                {
+                    const uint64_t square = mod[lane].mul(x[lane], x[lane]);
+                    const uint64_t rest = mod[lane].n - square;
+                    const uint64_t doubled = square >= rest ? square - rest : square + square;
+                    x[lane] = ((d[lane] >> bit) & 1) ? doubled : square; // branchless - exponent bits are random
+                }
+
+            return passes(x);
+        }
+
+        // any base - a fixed 4-bit window takes one multiply per exponent bit & one per window, not one per set bit
+        std::array<bool, Lanes> is_strong_probable_prime(uint64_t a) const
+        {
+            constexpr int window_bits = 4;
+
+            std::array<std::array<uint64_t, 1 << window_bits>, Lanes> powers{}; // a^0 ... a^15 in Montgomery form
+            std::array<uint64_t, Lanes> x{};
+            std::array<bool, Lanes> is_divisor{};
+
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                powers[lane][0] = mod[lane].one;
+                powers[lane][1] = mod[lane].to_montgomery(a);
+                for (size_t power = 2; power < powers[lane].size(); ++power)
+                    powers[lane][power] = mod[lane].mul(powers[lane][power - 1], powers[lane][1]);
+
+                x[lane] = mod[lane].one;
+                is_divisor[lane] = a % mod[lane].n == 0;
+            }
+
+            for (int window = (max_bit_width - 1) / window_bits; window >= 0; --window)
+            {
+                for (int i = 0; i < window_bits; ++i)
+                    for (size_t lane = 0; lane < Lanes; ++lane)
+                        x[lane] = mod[lane].mul(x[lane], x[lane]);
+
+                for (size_t lane = 0; lane < Lanes; ++lane)
+                    x[lane] = mod[lane].mul(x[lane], powers[lane][(d[lane] >> (window * window_bits)) % powers[lane].size()]);
+            }
+
+            auto is_passed = passes(x);
+            for (size_t lane = 0; lane < Lanes; ++lane)
+                is_passed[lane] = is_passed[lane] || is_divisor[lane]; // skipped like in the scalar test
+
+            return is_passed;
+        }
+    };
+} // namespace MillerRabin
+
+export constexpr bool is_prime(uint64_t n)
+{
+    const auto result = MillerRabin::trial_division(n);
+
+    if (result != MillerRabin::Result::unknown)
+        return result == MillerRabin::Result::prime;
+
+    return MillerRabin::is_strong_probable_prime(n);
+}
+
+// results[i] = is_prime(numbers[i]) - Miller-Rabin runs batch_lanes numbers at a time: the first round (base 2)
+// rejects almost all composites, the numbers passing it are batched again for the remaining bases
+export void is_prime(std::span<const uint64_t> numbers, std::span<bool> results)
+{
+    constexpr size_t batch_lanes = 8;
+    static_assert(MillerRabin::witnesses[0] == 2);
+
+    struct Pending
+    {
+        std::array<uint64_t, batch_lanes> numbers{};
+        std::array<size_t, batch_lanes> indexes{};
+        size_t size = 0;
+
+        // padding lanes repeat the first number
+        MillerRabin::Batch<batch_lanes> batch()
+        {
+            std::fill(numbers.begin() + size, numbers.end(), numbers[0]);
+            return MillerRabin::Batch<batch_lanes>{numbers};
+        }
+    };
+
+    Pending untested;
+    Pending base_2_passed;
+
+    auto test_remaining_bases = [&] {
+        const auto batch = base_2_passed.batch();
+
+        std::array<bool, batch_lanes> is_passed;
+        is_passed.fill(true);
+        for (uint64_t a : std::span{MillerRabin::witnesses}.subspan(1))
+        {
+            const auto is_passed_for_a = batch.is_strong_probable_prime(a);
+            for (size_t lane = 0; lane < batch_lanes; ++lane)
+                is_passed[lane] = is_passed[lane] && is_passed_for_a[lane];
+        }
+
+        for (size_t lane = 0; lane < base_2_passed.size; ++lane)
+            results[base_2_passed.indexes[lane]] = is_passed[lane];
+
+        base_2_passed.size = 0;
+    };
+
+    auto test_base_2 = [&] {
+        const auto is_passed = untested.batch().is_base_2_strong_probable_prime();
+
+        for (size_t lane = 0; lane < untested.size; ++lane)
+        {
+            if (!is_passed[lane])
+            {
+                results[untested.indexes[lane]] = false;
+                continue;
+            }
+
+            base_2_passed.numbers[base_2_passed.size] = untested.numbers[lane];
+            base_2_passed.indexes[base_2_passed.size] = untested.indexes[lane];
+            if (++base_2_passed.size == batch_lanes)
+                test_remaining_bases();
+        }
+
+        untested.size = 0;
+    };
+
+    for (size_t i = 0; i < numbers.size(); ++i)
+    {
+        const auto result = MillerRabin::trial_division(numbers[i]);
+
+        if (result != MillerRabin::Result::unknown)
+        {
+            results[i] = result == MillerRabin::Result::prime;
+            continue;
+        }
+
+        untested.numbers[untested.size] = numbers[i];
+        untested.indexes[untested.size] = i;
+        if (++untested.size == batch_lanes)
+            test_base_2();
+    }
+
+    if (untested.size > 0)
+        test_base_2();
+    if (base_2_passed.size > 0)
+        test_remaining_bases();
 }
 
+static_assert(is_prime(2) && !is_prime(1) && is_prime(1'000'000'007) && is_prime(18'446'744'073'709'551'557u));
+static_assert(!is_prime(3'215'031'751) && !is_prime(3'825'123'056'546'413'051)); // strong pseudoprimes to small bases
+
 export struct IsPrime
 {
-    bool operator()(uint32_t n) const
+    constexpr bool operator()(uint64_t n) const
     {
         return is_prime(n);
     }
+
+    void operator()(std::span<const uint64_t> numbers, std::span<bool> results) const
+    {
+        is_prime(numbers, results);
+    }
 };
 
-export template <uint32_t N>
-constexpr std::array<uint32_t, N> get_primes()
+//////////////////////////////////////////////////////////////////////////////
+// Segmented Sieve of Eratosthenes with 2*3*5*7 wheel (not exported)
+
+namespace Wheel
+{
+    inline constexpr uint32_t modulus = 2 * 3 * 5 * 7;
+
+    constexpr bool is_coprime(uint64_t n)
+    {
+        return n % 2 != 0 && n % 3 != 0 && n % 5 != 0 && n % 7 != 0;
+    }
+
+    // numbers in [0, 210) coprime to 210 - only multiples p * r of a sieving prime p are crossed off
+    inline constexpr auto residues = [] {
+        std::array<uint32_t, 48> residues{};
+
+        for (uint32_t r = 1, n = 0; r < modulus; ++r)
+            if (is_coprime(r))
+                residues[n++] = r;
+
+        return residues;
+    }();
+
+    // distance from residues[i] to the next residue (the last one wraps around the wheel)
+    inline constexpr auto gaps = [] {
+        std::array<uint32_t, residues.size()> gaps{};
+
+        for (size_t i = 0; i < residues.size() - 1; ++i)
+            gaps[i] = residues[i + 1] - residues[i];
+        gaps.back() = modulus + residues.front() - residues.back();
+
+        return gaps;
+    }();
+
+    // index of the smallest residue >= r for every r in [0, 210)
+    inline constexpr auto next_index = [] {
+        std::array<uint32_t, modulus> next_index{};
+
+        for (uint32_t r = 0; r < modulus; ++r)
+            next_index[r] = std::ranges::lower_bound(residues, r) - residues.begin();
+
+        return next_index;
+    }();
+
+    // pre-sieved pattern of odd numbers 2k+1 with multiples of 3, 5 & 7 removed (period 3 * 5 * 7)
+    inline constexpr auto odd_pattern = [] {
+        std::array<uint8_t, 3 * 5 * 7> pattern{};
+
+        for (uint64_t k = 0; k < pattern.size(); ++k)
+            pattern[k] = is_coprime(2 * k + 1);
+
+        return pattern;
+    }();
+} // namespace Wheel
+
+namespace Sieve
 {
-    std::array<uint32_t, N> primes{};
-    
-    uint32_t n = 0;
-    for (uint32_t i = 2; n < N; ++i)
-        if (is_prime(i))
+    // a segment of odd numbers fits into L1d cache (one byte per odd number)
+    inline constexpr size_t l1_segment_bytes = 32 * 1024;
+
+    constexpr uint64_t isqrt(uint64_t n)
+    {
+        uint64_t root = 0;
+
+        for (uint64_t bit = uint64_t{1} << 31; bit != 0; bit >>= 1)
+            if ((root + bit) * (root + bit) <= n)
+                root += bit;
+
+        return root;
+    }
+
+    // primes in [11, limit] - used to cross off composites in segments
+    std::vector<uint32_t> sieving_primes(uint64_t limit);
+
+    struct SievingPrime
+    {
+        uint32_t prime;
+        uint32_t wheel_index; // multiple == prime * factor, where factor % 210 == residues[wheel_index]
+        uint64_t multiple;    // next multiple to cross off
+    };
+
+    // first multiple prime * factor >= max(prime^2, start) with factor coprime to the wheel
+    constexpr SievingPrime first_multiple(uint32_t prime, uint64_t start)
+    {
+        uint64_t factor = std::max<uint64_t>(prime, (start + prime - 1) / prime);
+
+        const uint32_t wheel_index = Wheel::next_index[factor % Wheel::modulus];
+        factor += Wheel::residues[wheel_index] - factor % Wheel::modulus;
+
+        return SievingPrime{prime, wheel_index, prime * factor};
+    }
+
+    // calls on_prime(p) for every prime p in [lo, hi) in ascending order
+    // primes - sieving_primes(n) for any n >= isqrt(hi - 1) (shared by many ranges)
+    template <typename OnPrime>
+    void for_each_prime(uint64_t lo, uint64_t hi, const std::vector<uint32_t>& primes, OnPrime on_prime)
+    {
+        for (uint64_t p : {2, 3, 5, 7})
+            if (lo <= p && p < hi)
+                on_prime(p);
+
+        lo = std::max<uint64_t>(lo, 11) | 1; // only odd numbers are kept in segments
+        if (lo >= hi)
+            return;
+
+        std::vector<SievingPrime> multiples;
+        for (uint32_t p : primes)
         {
-            primes[n++] = i;
+            if (uint64_t{p} * p >= hi)
+                break;
+            multiples.push_back(first_multiple(p, lo));
         }
 
-    return primes;
+        std::vector<uint8_t> segment(std::min<uint64_t>(l1_segment_bytes, (hi - lo + 1) / 2));
+
+        for (uint64_t segment_lo = lo; segment_lo < hi; segment_lo += 2 * segment.size())
+        {
+            const uint64_t segment_hi = std::min<uint64_t>(hi, segment_lo + 2 * segment.size());
+            const size_t size = (segment_hi - segment_lo + 1) / 2;
+
+            // pre-sieve multiples of 3, 5 & 7 by copying the wheel pattern
+            for (size_t i = 0, k = (segment_lo / 2) % Wheel::odd_pattern.size(); i < size; ++i)
+            {
+                segment[i] = Wheel::odd_pattern[k];
+                if (++k == Wheel::odd_pattern.size())
+                    k = 0;
+            }
+
+            for (auto& sp : multiples)
+            {
+                if (sp.multiple >= segment_hi)
+                {
+                    if (uint64_t{sp.prime} * sp.prime >= segment_hi)
+                        break; // sieving primes are sorted - no more multiples in this segment
+                    continue;
+                }
+
+                for (; sp.multiple < segment_hi; sp.wheel_index = (sp.wheel_index + 1) % Wheel::gaps.size())
+                {
+                    segment[(sp.multiple - segment_lo) / 2] = 0;
+                    sp.multiple += uint64_t{sp.prime} * Wheel::gaps[sp.wheel_index];
+                }
+            }
+
+            for (size_t i = 0; i < size; ++i)
+                if (segment[i])
+                    on_prime(segment_lo + 2 * i);
+        }
+    }
+
+    template <typename OnPrime>
+    void for_each_prime(uint64_t lo, uint64_t hi, OnPrime on_prime)
+    {
+        if (lo < hi)
+            for_each_prime(lo, hi, sieving_primes(isqrt(hi - 1)), on_prime);
+    }
+
+    // upper bound of the n-th prime: p(n) < n * (ln(n) + ln(ln(n))) for n >= 6
+    constexpr uint64_t nth_prime_upper_bound(uint64_t n)
+    {
+        if (n < 6)
+            return 15;
+
+        const uint64_t log_n = std::bit_width(n); // bit_width(n) > log2(n) > ln(n)
+        return n * (log_n + std::bit_width(log_n));
+    }
+
+    // compile-time sieve of odd numbers up to nth_prime_upper_bound(N) - fixed-size arrays only
+    // (gcc 12 crashes evaluating a constexpr std::vector imported from a module)
+    template <uint32_t N>
+    consteval std::array<uint32_t, N> first_primes()
+    {
+        constexpr uint64_t limit = nth_prime_upper_bound(N);
+
+        std::array<bool, limit / 2 + 1> is_odd_composite{}; // is_odd_composite[k] represents 2k+1
+        std::array<uint32_t, N> primes{};
+
+        uint32_t n = 0;
+        if (n < N)
+            primes[n++] = 2;
+
+        for (uint64_t k = 1; n < N && 2 * k + 1 <= limit; ++k)
+        {
+            if (is_odd_composite[k])
+                continue;
+
+            const uint64_t p = 2 * k + 1;
+            primes[n++] = static_cast<uint32_t>(p);
+
+            for (uint64_t m = p * p; m <= limit; m += 2 * p)
+                is_odd_composite[m / 2] = true;
+        }
+
+        return primes;
+    }
+} // namespace Sieve
+
+// all primes <= limit
+export std::vector<uint32_t> primes_up_to(uint32_t limit);
+
+export template <uint32_t N>
+constexpr std::array<uint32_t, N> get_primes()
+{
+    return Sieve::first_primes<N>();
 }
 
 export template <uint32_t N>
-constexpr auto first_primes = get_primes<10>();
+constexpr auto first_primes = get_primes<N>();
+
+export const std::array first_100_primes = get_primes<100>();
+
+//////////////////////////////////////////////////////////////////////////////
+// Compressed prime tables - mod 30 wheel bitmap built at compile time
+
+// one byte per 30 numbers: bit k of byte i is set if 30 * i + offsets[k] is prime
+// (2, 3 & 5 are the only primes not coprime to 30); ~1/9 of the size of std::array<uint32_t, pi(Limit)>
+// note: tables above ~500'000 exceed gcc's default constexpr budget (-fconstexpr-ops-limit, MSVC: /constexpr:steps)
+export template <uint32_t Limit>
+class PrimeBitmap
+{
+public:
+    static constexpr std::array<uint32_t, 8> offsets = {1, 7, 11, 13, 17, 19, 23, 29};
+
+private:
+    static constexpr size_t byte_count = Limit / 30 + 1;
+    static constexpr size_t block_bytes = 32; // rank directory sample - 960 numbers
+
+    static constexpr std::array<uint32_t, 3> wheel_primes = {2, 3, 5};
+
+    static constexpr auto bit_index = [] {
+        std::array<uint8_t, 30> bit_index{};
+        bit_index.fill(0xFF);
+        for (uint8_t k = 0; k < offsets.size(); ++k)
+            bit_index[offsets[k]] = k;
+        return bit_index;
+    }();
+
+    std::array<uint8_t, byte_count> bits_{};
+    std::array<uint32_t, (byte_count + block_bytes - 1) / block_bytes> block_rank_{}; // primes > 5 before each block
+    uint32_t count_ = 0;
+
+public:
+    constexpr PrimeBitmap()
+    {
+        // sieve directly on the wheel - only 8 of every 30 numbers are ever touched,
+        // which keeps constant evaluation cheap
+        bits_.fill(0xFF);
+        bits_[0] &= ~1u; // 1 is not prime
+        for (uint32_t i = byte_count * 30 - 30; i < byte_count * 30; ++i)
+            if (i > Limit && bit_index[i % 30] != 0xFF)
+                bits_.back() &= ~(1u << bit_index[i % 30]);
+
+        for (uint64_t p = 7; p * p <= Limit; p += 2)
+        {
+            if (!::is_prime(p)) // the Miller-Rabin test - not the member is_prime() of the bitmap being built
+                continue;
+
+            // multiples p * (30 * j + offsets[k]) lie in byte p * j + p * offsets[k] / 30 at a fixed bit
+            std::array<uint64_t, offsets.size()> byte_offsets{};
+            std::array<uint8_t, offsets.size()> masks{};
+            for (size_t k = 0; k < offsets.size(); ++k)
+            {
+                byte_offsets[k] = p * offsets[k] / 30;
+                masks[k] = static_cast<uint8_t>(~(1u << bit_index[p * offsets[k] % 30]));
+            }
+
+            for (uint64_t j = p / 30; p * 30 * j <= Limit; ++j)
+                for (size_t k = 0; k < offsets.size(); ++k)
+                {
+                    const uint64_t m = 30 * j + offsets[k];
+                    if (m >= p && p * m <= Limit)
+                        bits_[p * j + byte_offsets[k]] &= masks[k];
+                }
+        }
+
+        uint32_t rank = 0;
+        for (size_t i = 0; i < byte_count; ++i)
+        {
+            if (i % block_bytes == 0)
+                block_rank_[i / block_bytes] = rank;
+            rank += std::popcount(bits_[i]);
+        }
+
+        count_ = rank + std::ranges::count_if(wheel_primes, [](uint32_t p) { return p <= Limit; });
+    }
+
+    static constexpr uint32_t limit()
+    {
+        return Limit;
+    }
+
+    // number of primes <= Limit
+    constexpr uint32_t count() const
+    {
+        return count_;
+    }
+
+    // O(1) lookup - n <= Limit
+    constexpr bool is_prime(uint32_t n) const
+    {
+        if (n < 7)
+            return n == 2 || n == 3 || n == 5;
+
+        const uint8_t k = bit_index[n % 30];
+        return k != 0xFF && (bits_[n / 30] >> k) & 1;
+    }
+
+    // number of primes <= n (pi(n)) - n <= Limit
+    constexpr uint32_t rank(uint32_t n) const
+    {
+        if (n < 7)
+            return static_cast<uint32_t>(std::ranges::count_if(wheel_primes, [n](uint32_t p) { return p <= n; }));
+
+        const size_t byte = n / 30;
+        uint32_t rank = wheel_primes.size() + block_rank_[byte / block_bytes];
+
+        for (size_t i = byte / block_bytes * block_bytes; i < byte; ++i)
+            rank += std::popcount(bits_[i]);
+
+        const uint32_t bits_up_to_n = static_cast<uint32_t>(std::ranges::upper_bound(offsets, n % 30) - offsets.begin());
+        return rank + std::popcount(static_cast<uint8_t>(bits_[byte] & ((1u << bits_up_to_n) - 1)));
+    }
+
+    // k-th prime (select(0) == 2) - k < count()
+    constexpr uint32_t select(uint32_t k) const
+    {
+        if (k < wheel_primes.size())
+            return wheel_primes[k];
+        k -= wheel_primes.size();
+
+        const size_t block = std::ranges::upper_bound(block_rank_, k) - block_rank_.begin() - 1;
+        k -= block_rank_[block];
+
+        for (size_t i = block * block_bytes;; ++i)
+        {
+            const uint32_t byte_rank = std::popcount(bits_[i]);
+            if (k < byte_rank)
+            {
+                uint8_t byte = bits_[i];
+                for (; k > 0; --k)
+                    byte &= byte - 1; // clear lowest set bit
+
+                return static_cast<uint32_t>(30 * i + offsets[std::countr_zero(byte)]);
+            }
+            k -= byte_rank;
+        }
+    }
+};
+
+export template <uint32_t Limit>
+constexpr PrimeBitmap<Limit> prime_bitmap{};
+
+static_assert(prime_bitmap<1'000>.count() == 168 && prime_bitmap<1'000>.select(99) == 541 && prime_bitmap<1'000>.rank(541) == 100);
+
+//////////////////////////////////////////////////////////////////////////////
+// Parallel mode - [lo, hi) is split into chunks sieved by a pool of threads
+// (defined in primes_parallel_impl.cpp - the pool grows std::vectors too, see primes_sieve_impl.cpp)
+
+namespace Parallel
+{
+    unsigned default_thread_count();
+
+    // calls on_chunk(context, primes) for the primes of consecutive chunks of [lo, hi) in ascending order
+    // on the calling thread, while the pool sieves a bounded window of chunks ahead
+    void for_each_chunk_in_order(uint64_t lo, uint64_t hi, unsigned num_threads, void (*on_chunk)(void*, std::span<const uint64_t>), void* context);
+} // namespace Parallel
+
+// number of primes in [lo, hi) (num_threads == 0 - one thread)
+export uint64_t count_primes(uint64_t lo, uint64_t hi, unsigned num_threads = Parallel::default_thread_count());
+
+// calls on_prime(p) for every prime p in [lo, hi) in ascending order on the calling thread,
+// while the pool sieves a bounded window of chunks ahead (num_threads == 0 - one thread)
+export template <typename OnPrime>
+void for_each_prime_parallel(uint64_t lo, uint64_t hi, OnPrime on_prime, unsigned num_threads = Parallel::default_thread_count())
+{
+    auto on_chunk = [](void* context, std::span<const uint64_t> primes) {
+        for (uint64_t p : primes)
+            (*static_cast<OnPrime*>(context))(p);
+    };
+
+    Parallel::for_each_chunk_in_order(lo, hi, num_threads, on_chunk, &on_prime);
+}
 
-export const std::array first_100_primes = get_primes<100>();
\ No newline at end of file
+// all primes in [lo, hi) (num_threads == 0 - one thread)
+export std::vector<uint64_t> primes_in_range(uint64_t lo, uint64_t hi, unsigned num_threads = Parallel::default_thread_count());
@@ -0,0 +1,154 @@
+module; // global fragment module
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <span>
+#include <vector>
+
+module Primes;
+
+namespace Parallel
+{
+    // numbers per task - 64 L1-sized segments
+    constexpr uint64_t chunk_size = 64 * 2 * Sieve::l1_segment_bytes;
+
+    unsigned default_thread_count()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+} // namespace Parallel
+
+uint64_t count_primes(uint64_t lo, uint64_t hi, unsigned num_threads)
+{
+    if (lo >= hi)
+        return 0;
+
+    num_threads = std::max(num_threads, 1u);
+
+    const auto primes = Sieve::sieving_primes(Sieve::isqrt(hi - 1));
+    const uint64_t chunk_count = (hi - lo - 1) / Parallel::chunk_size + 1;
+
+    std::atomic<uint64_t> next_chunk{0};
+    std::atomic<uint64_t> total_count{0};
+
+    auto worker = [&] {
+        uint64_t count = 0;
+
+        for (uint64_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+        {
+            const uint64_t chunk_lo = lo + chunk * Parallel::chunk_size;
+            const uint64_t chunk_hi = std::min(hi, chunk_lo + Parallel::chunk_size);
+
+            Sieve::for_each_prime(chunk_lo, chunk_hi, primes, [&count](uint64_t) { ++count; });
+        }
+
+        total_count += count;
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned i = 0; i < std::min<uint64_t>(num_threads, chunk_count); ++i)
+            pool.emplace_back(worker);
+    } // join
+
+    return total_count;
+}
+
+namespace Parallel
+{
+    void for_each_chunk_in_order(uint64_t lo, uint64_t hi, unsigned num_threads, void (*on_chunk)(void*, std::span<const uint64_t>), void* context)
+    {
+        if (lo >= hi)
+            return;
+
+        num_threads = std::max(num_threads, 1u);
+
+        const auto primes = Sieve::sieving_primes(Sieve::isqrt(hi - 1));
+        const uint64_t chunk_count = (hi - lo - 1) / chunk_size + 1;
+        const uint64_t window = 2 * uint64_t{num_threads};
+
+        struct Slot
+        {
+            std::vector<uint64_t> primes;
+            bool is_ready = false;
+        };
+
+        std::vector<Slot> slots(window);
+        std::mutex mtx;
+        std::condition_variable cv;
+        uint64_t next_chunk = 0;
+        uint64_t consumed = 0;
+        bool is_cancelled = false;
+
+        auto worker = [&] {
+            while (true)
+            {
+                uint64_t chunk;
+                {
+                    std::unique_lock lk{mtx};
+                    cv.wait(lk, [&] { return is_cancelled || next_chunk == chunk_count || next_chunk < consumed + window; });
+                    if (is_cancelled || next_chunk == chunk_count)
+                        return;
+                    chunk = next_chunk++;
+                }
+
+                const uint64_t chunk_lo = lo + chunk * chunk_size;
+                const uint64_t chunk_hi = std::min(hi, chunk_lo + chunk_size);
+
+                std::vector<uint64_t> found;
+                Sieve::for_each_prime(chunk_lo, chunk_hi, primes, [&found](uint64_t p) { found.push_back(p); });
+
+                {
+                    std::lock_guard lk{mtx};
+                    slots[chunk % window] = Slot{std::move(found), true};
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::jthread> pool;
+        for (unsigned i = 0; i < std::min<uint64_t>(num_threads, chunk_count); ++i)
+            pool.emplace_back(worker);
+
+        try
+        {
+            while (consumed < chunk_count)
+            {
+                std::vector<uint64_t> found;
+                {
+                    std::unique_lock lk{mtx};
+                    Slot& slot = slots[consumed % window];
+                    cv.wait(lk, [&] { return slot.is_ready; });
+                    found = std::move(slot.primes);
+                    slot.is_ready = false;
+                    ++consumed;
+                }
+                cv.notify_all();
+
+                on_chunk(context, found);
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard lk{mtx};
+                is_cancelled = true;
+            }
+            cv.notify_all();
+            throw;
+        }
+    }
+} // namespace Parallel
+
+std::vector<uint64_t> primes_in_range(uint64_t lo, uint64_t hi, unsigned num_threads)
+{
+    std::vector<uint64_t> primes;
+    for_each_prime_parallel(lo, hi, [&primes](uint64_t p) { primes.push_back(p); }, num_threads);
+
+    return primes;
+}
@@ -0,0 +1,46 @@
+module; // global fragment module
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+module Primes;
+
+// std::vector growth is instantiated here, not in the interface - gcc 12 miscompiles it in importing units
+// (they read numeric limits through a null address) once the interface has instantiated it
+
+namespace Sieve
+{
+    std::vector<uint32_t> sieving_primes(uint64_t limit)
+    {
+        std::vector<uint32_t> primes;
+
+        if (limit < 11)
+            return primes;
+
+        std::vector<uint8_t> is_odd_prime(limit / 2 + 1, 1); // is_odd_prime[k] represents 2k+1
+
+        for (uint64_t k = 1; (2 * k + 1) * (2 * k + 1) <= limit; ++k)
+            if (is_odd_prime[k])
+                for (uint64_t m = (2 * k + 1) * (2 * k + 1); m <= limit; m += 2 * (2 * k + 1))
+                    is_odd_prime[m / 2] = 0;
+
+        for (uint64_t n = 11; n <= limit; n += 2)
+            if (is_odd_prime[n / 2])
+                primes.push_back(static_cast<uint32_t>(n));
+
+        return primes;
+    }
+} // namespace Sieve
+
+std::vector<uint32_t> primes_up_to(uint32_t limit)
+{
+    std::vector<uint32_t> primes;
+    if (limit > 10)
+        primes.reserve(static_cast<size_t>(1.25 * limit / std::log(limit))); // pi(n) < 1.25506 * n / ln(n)
+
+    Sieve::for_each_prime(0, uint64_t{limit} + 1, [&primes](uint64_t p) { primes.push_back(static_cast<uint32_t>(p)); });
+
+    return primes;
+}
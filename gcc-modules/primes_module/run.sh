@@ -3,8 +3,10 @@
 mkdir build
 cd build
 
-g++ --std=c++20 -fmodules-ts -c ../primes.cpp
-g++ --std=c++20 -fmodules-ts -c ../client_primes.cpp
-g++ -std=c++20 client_primes.o primes.o -o primes_main
+g++ --std=c++20 -O2 -fmodules-ts -c ../primes.cpp
+g++ --std=c++20 -O2 -fmodules-ts -c ../primes_sieve_impl.cpp
+g++ --std=c++20 -O2 -fmodules-ts -c ../primes_parallel_impl.cpp
+g++ --std=c++20 -O2 -fmodules-ts -c ../client_primes.cpp
+g++ -std=c++20 client_primes.o primes.o primes_sieve_impl.o primes_parallel_impl.o -o primes_main
 
 ./primes_main
\ No newline at end of file
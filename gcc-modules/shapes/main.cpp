@@ -1,5 +1,84 @@
 import Shapes;
 import <iostream>;
+import <sstream>;
+import <string>;
+import <vector>;
+import <chrono>;
+import <filesystem>;
+import <algorithm>;
+import <system_error>;
+
+template <typename F>
+auto measure(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = f();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::pair{result, std::chrono::duration_cast<std::chrono::milliseconds>(end - start)};
+}
+
+void benchmark_scene_loading()
+{
+    const size_t point_count = 2'000'000;
+
+    std::vector<Shapes::Point> points;
+    points.reserve(point_count);
+    for (size_t i = 0; i < point_count; ++i)
+        points.emplace_back(static_cast<int>(i % 1920) - 960, static_cast<int>(i / 1920) * 7 - 5000);
+
+    std::ostringstream text_out;
+    for (const auto& pt : points)
+        text_out << pt << "\n";
+    const std::string text = std::move(text_out).str();
+
+    const auto scene_file = (std::filesystem::temp_directory_path() / "shapes_scene.bin").string();
+    Shapes::save_scene(scene_file, points);
+
+    std::cout << "\nloading " << point_count << " points (text: " << text.size() / 1'000'000.0 << " MB):\n";
+
+    auto [stream_points, stream_time] = measure([&] {
+        std::vector<Shapes::Point> loaded;
+        std::istringstream in{text};
+        loaded.reserve(point_count);
+        for (Shapes::Point pt; loaded.size() < point_count && in >> pt;) // operator>> throws at the end of stream
+            loaded.push_back(pt);
+        return loaded;
+    });
+    std::cout << "  operator>>:          " << stream_time.count() << " ms\n";
+
+    auto [parsed_points, parse_time] = measure([&] {
+        std::vector<Shapes::Point> loaded;
+        loaded.reserve(text.size() / 8);
+        if (auto [end, error] = Shapes::parse_points(text, loaded); error != std::errc{})
+            std::cout << "  parse error at offset " << end - text.data() << "\n";
+        return loaded;
+    });
+    std::cout << "  parse_points:        " << parse_time.count() << " ms\n";
+
+    auto [sum, mapped_time] = measure([&] {
+        Shapes::MappedScene scene{scene_file};
+        long long sum = 0;
+        for (const auto& pt : scene.points()) // touches every page of the file
+            sum += pt.x + pt.y;
+        return sum;
+    });
+    std::cout << "  MappedScene (+ sum): " << mapped_time.count() << " ms\n";
+
+    long long expected_sum = 0;
+    for (const auto& pt : points)
+        expected_sum += pt.x + pt.y;
+
+    auto same_points = [&](const std::vector<Shapes::Point>& loaded) {
+        return loaded.size() == points.size()
+            && std::equal(loaded.begin(), loaded.end(), points.begin(), [](const auto& a, const auto& b) { return a.x == b.x && a.y == b.y; });
+    };
+
+    if (!same_points(stream_points) || !same_points(parsed_points) || sum != expected_sum)
+        std::cout << "  ERROR: loaded points differ\n";
+
+    std::filesystem::remove(scene_file);
+}
 
 int main()
 {
@@ -10,4 +89,11 @@ int main()
     pt.translate(20, 40);
 
     std::cout << pt << "\n";
+
+    const std::string text = " [1,2]\n[ -3 , 4 ] [5,x]";
+    std::vector<Shapes::Point> points;
+    auto [end, error] = Shapes::parse_points(text, points);
+    std::cout << "parsed " << points.size() << " points, error at offset " << end - text.data() << "\n";
+
+    benchmark_scene_loading();
 }
\ No newline at end of file
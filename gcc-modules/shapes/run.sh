@@ -6,11 +6,25 @@ cd build
 g++ -std=c++20 -fmodules-ts -xc++-system-header iostream
 g++ -std=c++20 -fmodules-ts -xc++-system-header string
 g++ -std=c++20 -fmodules-ts -xc++-system-header vector
+g++ -std=c++20 -fmodules-ts -xc++-system-header string_view
+g++ -std=c++20 -fmodules-ts -xc++-system-header span
+g++ -std=c++20 -fmodules-ts -xc++-system-header bit
+g++ -std=c++20 -fmodules-ts -xc++-system-header cstdint
+g++ -std=c++20 -fmodules-ts -xc++-system-header cstring
+g++ -std=c++20 -fmodules-ts -xc++-system-header charconv
+g++ -std=c++20 -fmodules-ts -xc++-system-header fstream
+g++ -std=c++20 -fmodules-ts -xc++-system-header sstream
+g++ -std=c++20 -fmodules-ts -xc++-system-header stdexcept
+g++ -std=c++20 -fmodules-ts -xc++-system-header system_error
+g++ -std=c++20 -fmodules-ts -xc++-system-header chrono
+g++ -std=c++20 -fmodules-ts -xc++-system-header filesystem
+g++ -std=c++20 -fmodules-ts -xc++-system-header algorithm
 
-g++ --std=c++20 -fmodules-ts -xc++ -c ../shapes_point.cxx
-g++ --std=c++20 -fmodules-ts -xc++ -c ../shapes_base.cxx
-g++ --std=c++20 -fmodules-ts -xc++ -c ../shapes.cxx
-g++ --std=c++20 -fmodules-ts -xc++ -c ../main.cpp
-g++ shapes.o shapes_point.o shapes_base.o main.o -o shapes_app
+g++ --std=c++20 -O2 -fmodules-ts -xc++ -c ../shapes_point.cxx
+g++ --std=c++20 -O2 -fmodules-ts -xc++ -c ../shapes_base.cxx
+g++ --std=c++20 -O2 -fmodules-ts -xc++ -c ../shapes_scene.cxx
+g++ --std=c++20 -O2 -fmodules-ts -xc++ -c ../shapes.cxx
+g++ --std=c++20 -O2 -fmodules-ts -xc++ -c ../main.cpp
+g++ shapes.o shapes_point.o shapes_base.o shapes_scene.o main.o -o shapes_app
 
 ./shapes_app
\ No newline at end of file
@@ -2,5 +2,6 @@ export module Shapes;
 
 export import :Point;
 export import :Base;
+export import :Scene;
 // export import :Rectangle;
 // export import :Square;
\ No newline at end of file
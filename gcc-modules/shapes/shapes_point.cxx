@@ -1,6 +1,8 @@
 export module Shapes:Point;
 
 import <iostream>;
+import <charconv>;
+import <system_error>;
 
 export
 namespace Shapes
@@ -25,6 +27,13 @@ namespace Shapes
 	std::ostream& operator<<(std::ostream& out, const Point& pt);
 
 	std::istream& operator>>(std::istream& in, Point& pt);
+
+	// skips the whitespace allowed between tokens (' ', '\n', '\t', '\r') - returns last if only whitespace is left
+	const char* skip_whitespace(const char* first, const char* last) noexcept;
+
+	// parses "[x,y]" (whitespace allowed between tokens, like operator>>) without iostreams & exceptions;
+	// on error ptr points at the offending character, like std::from_chars
+	std::from_chars_result from_chars(const char* first, const char* last, Point& pt) noexcept;
 }
 
 static constexpr const char opening_bracket = '[';
@@ -61,4 +70,48 @@ namespace Shapes
 
 		return in;
 	}
+
+	const char* skip_whitespace(const char* first, const char* last) noexcept
+	{
+		while (first != last && (*first == ' ' || *first == '\n' || *first == '\t' || *first == '\r'))
+			++first;
+
+		return first;
+	}
+
+	namespace
+	{
+		std::from_chars_result expect(const char* first, const char* last, char token) noexcept
+		{
+			first = skip_whitespace(first, last);
+
+			if (first == last || *first != token)
+				return {first, std::errc::invalid_argument};
+
+			return {first + 1, std::errc{}};
+		}
+	}
+
+	std::from_chars_result from_chars(const char* first, const char* last, Point& pt) noexcept
+	{
+		int x, y;
+		std::from_chars_result result = expect(first, last, opening_bracket);
+
+		if (result.ec == std::errc{})
+			result = std::from_chars(skip_whitespace(result.ptr, last), last, x);
+		if (result.ec == std::errc{})
+			result = expect(result.ptr, last, comma);
+		if (result.ec == std::errc{})
+			result = std::from_chars(skip_whitespace(result.ptr, last), last, y);
+		if (result.ec == std::errc{})
+			result = expect(result.ptr, last, closing_bracket);
+
+		if (result.ec == std::errc{})
+		{
+			pt.x = x;
+			pt.y = y;
+		}
+
+		return result;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+module; // global module fragment - POSIX headers are not importable
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+export module Shapes:Scene;
+
+import :Point;
+
+import <string>;
+import <string_view>;
+import <vector>;
+import <span>;
+import <bit>;
+import <cstdint>;
+import <cstring>;
+import <charconv>;
+import <fstream>;
+import <stdexcept>;
+import <system_error>;
+
+export
+namespace Shapes
+{
+	// binary scene file:
+	//   header - SceneHeader, 32 bytes
+	//   points - point_count x [int32 x, int32 y], little-endian, at points_offset (8-byte aligned)
+	// x & y of a point stay together, so the block can be used in place as std::span<const Point>;
+	// attributes added in later versions go to separate fixed-width blocks after it
+	struct SceneHeader
+	{
+		static constexpr char file_magic[4] = {'S', 'H', 'P', 'S'};
+		static constexpr std::uint16_t current_version = 1;
+
+		char magic[4];
+		std::uint16_t version;
+		std::uint16_t header_size;
+		std::uint32_t reserved;
+		std::uint32_t point_size;
+		std::uint64_t point_count;
+		std::uint64_t points_offset;
+	};
+
+	static_assert(sizeof(SceneHeader) == 32);
+
+	// mmap-ed data is used as is - the layout of Point must match the file
+	static_assert(std::endian::native == std::endian::little, "binary scenes are stored little-endian");
+	static_assert(sizeof(Point) == 2 * sizeof(std::int32_t) && alignof(Point) <= 8);
+
+	void save_scene(const std::string& file_name, std::span<const Point> points);
+
+	// read-only view of a binary scene mapped into memory - points are not copied
+	class MappedScene
+	{
+		const std::byte* data_ = nullptr;
+		std::size_t size_ = 0;
+		std::span<const Point> points_;
+
+		void validate(const std::string& file_name);
+
+	public:
+		explicit MappedScene(const std::string& file_name);
+
+		MappedScene(const MappedScene&) = delete;
+		MappedScene& operator=(const MappedScene&) = delete;
+
+		~MappedScene();
+
+		std::span<const Point> points() const noexcept
+		{
+			return points_;
+		}
+	};
+
+	// appends points from text with whitespace separated "[x,y]" - stops at the first error
+	std::from_chars_result parse_points(std::string_view text, std::vector<Point>& points);
+}
+
+namespace Shapes
+{
+	void save_scene(const std::string& file_name, std::span<const Point> points)
+	{
+		SceneHeader header{};
+		std::memcpy(header.magic, SceneHeader::file_magic, sizeof(header.magic));
+		header.version = SceneHeader::current_version;
+		header.header_size = sizeof(SceneHeader);
+		header.point_size = sizeof(Point);
+		header.point_count = points.size();
+		header.points_offset = sizeof(SceneHeader);
+
+		std::ofstream out{file_name, std::ios::binary | std::ios::trunc};
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(points.data()), points.size_bytes());
+
+		if (!out.flush())
+			throw std::runtime_error{"cannot write scene: " + file_name};
+	}
+
+	MappedScene::MappedScene(const std::string& file_name)
+	{
+		const int fd = ::open(file_name.c_str(), O_RDONLY);
+		if (fd == -1)
+			throw std::system_error{errno, std::generic_category(), file_name};
+
+		struct stat info;
+		if (::fstat(fd, &info) == -1)
+		{
+			const int error = errno;
+			::close(fd);
+			throw std::system_error{error, std::generic_category(), file_name};
+		}
+
+		size_ = static_cast<std::size_t>(info.st_size);
+
+		if (size_ > 0)
+		{
+			void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				const int error = errno;
+				::close(fd);
+				throw std::system_error{error, std::generic_category(), file_name};
+			}
+
+			data_ = static_cast<const std::byte*>(data);
+		}
+
+		::close(fd); // mapping stays valid
+
+		try
+		{
+			validate(file_name);
+		}
+		catch (...)
+		{
+			if (data_)
+				::munmap(const_cast<std::byte*>(data_), size_); // destructor is not called
+			throw;
+		}
+	}
+
+	void MappedScene::validate(const std::string& file_name)
+	{
+		SceneHeader header;
+		if (size_ < sizeof(header))
+			throw std::runtime_error{"not a scene file: " + file_name};
+
+		std::memcpy(&header, data_, sizeof(header));
+
+		if (std::memcmp(header.magic, SceneHeader::file_magic, sizeof(header.magic)) != 0)
+			throw std::runtime_error{"not a scene file: " + file_name};
+
+		// newer versions may only append fields to the header & blocks to the file
+		if (header.version == 0 || header.header_size < sizeof(SceneHeader) || header.point_size != sizeof(Point))
+			throw std::runtime_error{"unsupported scene format: " + file_name};
+
+		// points must not overlap the header (also a longer one from a newer version)
+		if (header.points_offset < header.header_size || header.points_offset % alignof(Point) != 0
+			|| header.points_offset > size_ || header.point_count > (size_ - header.points_offset) / sizeof(Point))
+			throw std::runtime_error{"corrupted scene file: " + file_name};
+
+		// mmap returns page-aligned memory, so the block is aligned for Point
+		points_ = {reinterpret_cast<const Point*>(data_ + header.points_offset), static_cast<std::size_t>(header.point_count)};
+	}
+
+	MappedScene::~MappedScene()
+	{
+		if (data_)
+			::munmap(const_cast<std::byte*>(data_), size_);
+	}
+
+	std::from_chars_result parse_points(std::string_view text, std::vector<Point>& points)
+	{
+		const char* first = text.data();
+		const char* const last = text.data() + text.size();
+
+		while (true)
+		{
+			first = skip_whitespace(first, last);
+
+			if (first == last)
+				return {first, std::errc{}};
+
+			Point pt;
+			auto [end, error] = from_chars(first, last, pt);
+			if (error != std::errc{})
+				return {end, error};
+
+			points.push_back(pt);
+			first = end;
+		}
+	}
+}
@@ -1,6 +1,488 @@
 import Shapes;
+import Singleton;
 import std;
 
+// counts calls of the global operator new - for the allocation benchmark
+std::atomic<std::size_t> global_new_calls{0};
+
+void* operator new(std::size_t size)
+{
+	++global_new_calls;
+
+	if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+template <typename F>
+auto measure(F&& f)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto result = f();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::pair{result, std::chrono::duration_cast<std::chrono::microseconds>(end - start)};
+}
+
+// shapes for benchmarks - every other one is a square
+template <typename F>
+void generate_shapes(size_t count, F&& on_shape)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int x = static_cast<int>(i % 1000), y = static_cast<int>(i / 1000);
+
+		if (i % 2 == 0)
+			on_shape(Shapes::Rectangle{x, y, 10, 20});
+		else
+			on_shape(Shapes::Square{x, y, 15});
+	}
+}
+
+void benchmark_move_all()
+{
+	const size_t shape_count = 1'000'000;
+	const int frame_count = 20;
+
+	std::vector<std::unique_ptr<Shapes::Shape>> shapes;
+	Shapes::ShapeBatch batch;
+	batch.reserve(shape_count / 2, shape_count / 2);
+
+	generate_shapes(shape_count, [&]<typename TShape>(const TShape& shape) {
+		shapes.push_back(std::make_unique<TShape>(shape));
+		batch.add(shape);
+	});
+
+	auto [virtual_frames, virtual_time] = measure([&] {
+		for (int frame = 0; frame < frame_count; ++frame)
+			for (const auto& shape : shapes)
+				shape->move(1, -1);
+		return frame_count;
+	});
+
+	auto [batch_frames, batch_time] = measure([&] {
+		for (int frame = 0; frame < frame_count; ++frame)
+			batch.move_all(1, -1);
+		return frame_count;
+	});
+
+	std::cout << "\nmove " << shape_count << " shapes x " << frame_count << " frames:\n"
+		<< "  vector<unique_ptr<Shape>>: " << virtual_time << " (" << virtual_time.count() * 1000.0 / (shape_count * frame_count) << " ns/shape)\n"
+		<< "  ShapeBatch::move_all:      " << batch_time << " (" << batch_time.count() * 1000.0 / (shape_count * frame_count) << " ns/shape)\n";
+
+	const auto* last = dynamic_cast<const Shapes::Square*>(shapes.back().get());
+	if (last->coord().x != batch.square(batch.square_count() - 1).coord().x)
+		std::cout << "  ERROR: ShapeBatch differs from shapes moved one by one\n";
+}
+
+void benchmark_any_shape()
+{
+	const size_t shape_count = 1'000'000;
+	const int frame_count = 20;
+
+	std::vector<std::unique_ptr<Shapes::Shape>> shapes;
+	std::vector<Shapes::AnyShape> any_shapes;
+	any_shapes.reserve(shape_count);
+
+	size_t heap_bytes = 0;
+	generate_shapes(shape_count, [&]<typename TShape>(const TShape& shape) {
+		shapes.push_back(std::make_unique<TShape>(shape));
+		any_shapes.push_back(shape);
+		heap_bytes += sizeof(TShape) + 16; // + typical malloc chunk overhead
+	});
+
+	auto [virtual_frames, virtual_time] = measure([&] {
+		for (int frame = 0; frame < frame_count; ++frame)
+			for (const auto& shape : shapes)
+				shape->move(1, -1);
+		return frame_count;
+	});
+
+	auto [variant_frames, variant_time] = measure([&] {
+		for (int frame = 0; frame < frame_count; ++frame)
+			Shapes::move_all(any_shapes, 1, -1);
+		return frame_count;
+	});
+
+	std::cout << "\nmove " << shape_count << " shapes x " << frame_count << " frames:\n"
+		<< "  vector<unique_ptr<Shape>>: " << virtual_time << " (" << virtual_time.count() * 1000.0 / (shape_count * frame_count) << " ns/shape), "
+		<< (shapes.capacity() * sizeof(shapes[0]) + heap_bytes) / double(shape_count) << " B/shape\n"
+		<< "  vector<AnyShape>:          " << variant_time << " (" << variant_time.count() * 1000.0 / (shape_count * frame_count) << " ns/shape), "
+		<< any_shapes.capacity() * sizeof(Shapes::AnyShape) / double(shape_count) << " B/shape\n";
+}
+
+// creates & destroys shapes in batches of shapes.capacity()
+template <typename TFactory, typename TShapePtr>
+size_t create_and_destroy(const TFactory& factory, std::vector<TShapePtr>& shapes, size_t round_count)
+{
+	const std::string ids[] = {Shapes::Rectangle::id, Shapes::Square::id}; // short strings - no allocation
+
+	for (size_t round = 0; round < round_count; ++round)
+	{
+		for (size_t i = 0; i < shapes.capacity(); ++i)
+			shapes.push_back(factory.create(ids[i % 2]));
+		shapes.clear();
+	}
+
+	return round_count * shapes.capacity();
+}
+
+void benchmark_factory_allocations()
+{
+	Shapes::ShapeFactory factory;
+	factory.register_creator(Shapes::Rectangle::id, &std::make_unique<Shapes::Rectangle>);
+	factory.register_creator(Shapes::Square::id, &std::make_unique<Shapes::Square>);
+
+	Shapes::PooledShapeFactory pooled_factory;
+	pooled_factory.register_creator(Shapes::Rectangle::id, Shapes::PooledShapeCreator::for_type<Shapes::Rectangle>());
+	pooled_factory.register_creator(Shapes::Square::id, Shapes::PooledShapeCreator::for_type<Shapes::Square>());
+
+	std::vector<std::unique_ptr<Shapes::Shape>> shapes;
+	shapes.reserve(1'000);
+	std::vector<Shapes::PooledShapePtr> pooled_shapes;
+	pooled_shapes.reserve(1'000);
+
+	create_and_destroy(pooled_factory, pooled_shapes, 1); // warm-up - pools reach their steady-state size
+
+	std::cout << "\ncreate & destroy shapes:\n";
+
+	auto report = [](const char* name, auto&& benchmark) {
+		const size_t new_calls_before = global_new_calls;
+		auto [count, time] = measure(benchmark);
+		std::cout << "  " << name << count << " shapes in " << time << " - " << count * 1'000'000.0 / std::max<long long>(1, time.count())
+			<< " shapes/s, operator new calls: " << global_new_calls - new_calls_before << "\n";
+	};
+
+	report("GenericFactory:          ", [&] { return create_and_destroy(factory, shapes, 5'000); });
+	report("GenericFactory (pooled): ", [&] { return create_and_destroy(pooled_factory, pooled_shapes, 5'000); });
+}
+
+void benchmark_factory_lookup()
+{
+	const std::string ids[] = {Shapes::Rectangle::id, Shapes::Square::id, "RuntimeSquare"};
+	const size_t create_count = 5'000'000;
+
+	Shapes::PooledShapeFactory factory;
+	Shapes::StaticPooledShapeFactory static_factory{Shapes::builtin_shape_ids};
+
+	factory.register_creator(ids[0], Shapes::PooledShapeCreator::for_type<Shapes::Rectangle>());
+	factory.register_creator(ids[1], Shapes::PooledShapeCreator::for_type<Shapes::Square>());
+	factory.register_creator(ids[2], Shapes::PooledShapeCreator::for_type<Shapes::Square>());
+	static_factory.register_creator(ids[0], Shapes::PooledShapeCreator::for_type<Shapes::Rectangle>());
+	static_factory.register_creator(ids[1], Shapes::PooledShapeCreator::for_type<Shapes::Square>());
+	static_factory.register_creator(ids[2], Shapes::PooledShapeCreator::for_type<Shapes::Square>()); // not a built-in id
+
+	// pooled creators - the time is dominated by finding the creator
+	auto create_all = [&](const auto& factory, size_t first_id, size_t id_count) {
+		size_t created = 0;
+		for (size_t i = 0; i < create_count; ++i)
+			created += factory.create(ids[first_id + i % id_count]) != nullptr;
+		return created;
+	};
+
+	std::cout << "\nfactory lookup & create:\n";
+
+	auto report = [&](const char* name, std::chrono::microseconds time) {
+		std::cout << "  " << name << time.count() * 1000.0 / create_count << " ns/call\n";
+	};
+
+	report("GenericFactory (unordered_map), built-in ids: ", measure([&] { return create_all(factory, 0, 2); }).second);
+	report("StaticFactory (perfect hash), built-in ids:   ", measure([&] { return create_all(static_factory, 0, 2); }).second);
+	report("GenericFactory (unordered_map), runtime id:   ", measure([&] { return create_all(factory, 2, 1); }).second);
+	report("StaticFactory (fallback map), runtime id:     ", measure([&] { return create_all(static_factory, 2, 1); }).second);
+
+	// lookup only - a catalogue of shape ids larger than the two built-in ones
+	constexpr std::array<std::string_view, 24> catalogue_ids = {"Rectangle", "Square", "Circle", "Ellipse", "Triangle", "Polygon",
+		"Line", "Polyline", "Arc", "Bezier", "Text", "Image", "Star", "Arrow", "RoundedRectangle", "Parallelogram", "Trapezoid",
+		"Rhombus", "Hexagon", "Octagon", "Pentagon", "Ring", "Sector", "Spline"};
+	constexpr PerfectHash<catalogue_ids.size()> catalogue_index{catalogue_ids};
+
+	std::unordered_map<std::string, size_t> catalogue_map;
+	std::vector<std::string> queries;
+	for (size_t i = 0; i < catalogue_ids.size(); ++i)
+	{
+		catalogue_map.emplace(catalogue_ids[i], i);
+		queries.emplace_back(catalogue_ids[i]);
+	}
+
+	auto [map_sum, map_time] = measure([&] {
+		size_t sum = 0;
+		for (size_t i = 0; i < create_count; ++i)
+			sum += catalogue_map.find(queries[i * 7 % queries.size()])->second;
+		return sum;
+	});
+	report("unordered_map<string> lookup, 24 ids:         ", map_time);
+
+	auto [hash_sum, hash_time] = measure([&] {
+		size_t sum = 0;
+		for (size_t i = 0; i < create_count; ++i)
+			sum += *catalogue_index.find(queries[i * 7 % queries.size()]);
+		return sum;
+	});
+	report("PerfectHash lookup, 24 ids:                   ", hash_time);
+
+	if (map_sum != hash_sum)
+		std::cout << "  lookup results differ!\n";
+}
+
+// state read on a hot path - constant-initializable, so it can be held with the EagerConstinit policy
+struct DrawSettings
+{
+	int scale = 1;
+};
+
+template <template <typename> class TCreationPolicy>
+long long sum_scales(size_t call_count)
+{
+	long long sum = 0;
+	for (size_t i = 0; i < call_count; ++i)
+	{
+		sum += Singleton::SingletonHolder<DrawSettings, TCreationPolicy>::instance().scale;
+		std::atomic_signal_fence(std::memory_order_seq_cst); // instance() must not be hoisted out of the loop
+	}
+	return sum;
+}
+
+void benchmark_singleton_access()
+{
+	const size_t call_count = 20'000'000;
+
+	std::cout << "\nSingletonHolder::instance() from many threads:\n";
+
+	auto report = [&](const char* name, auto access) {
+		std::cout << "  " << name;
+		for (size_t thread_count : {1, 4, 16})
+		{
+			auto [sum, time] = measure([&] {
+				std::atomic<long long> sum{0};
+				{
+					std::vector<std::jthread> threads;
+					for (size_t i = 0; i < thread_count; ++i)
+						threads.emplace_back([&] { sum += access(call_count); });
+				}
+				return sum.load();
+			});
+			std::cout << thread_count << " threads: " << time.count() * 1000.0 / (call_count * thread_count) << " ns/call"
+				<< (sum == static_cast<long long>(call_count * thread_count) ? "" : " (wrong sum!)") << (thread_count < 16 ? ", " : "\n");
+		}
+	};
+
+	report("LazyStatic:        ", &sum_scales<Singleton::LazyStatic>);
+	report("ThreadLocalCached: ", &sum_scales<Singleton::ThreadLocalCached>);
+	report("EagerConstinit:    ", &sum_scales<Singleton::EagerConstinit>);
+}
+
+void benchmark_spatial_index()
+{
+	const size_t shape_count = 1'000'000;
+	const Shapes::Box area{{0, 0}, {100'000, 100'000}};
+
+	std::mt19937 gen{42};
+	std::uniform_int_distribution<int> position{area.min.x, area.max.x};
+	std::uniform_int_distribution<int> extent{10, 200};
+
+	std::vector<Shapes::AnyShape> shapes;
+	std::vector<Shapes::Box> boxes;
+	shapes.reserve(shape_count);
+	boxes.reserve(shape_count);
+	for (size_t i = 0; i < shape_count; ++i)
+	{
+		if (i % 2 == 0)
+			shapes.push_back(Shapes::Rectangle{position(gen), position(gen), extent(gen), extent(gen)});
+		else
+			shapes.push_back(Shapes::Square{position(gen), position(gen), extent(gen)});
+		boxes.push_back(Shapes::bounds(shapes.back()));
+	}
+
+	std::vector<Shapes::Point> points(100'000);
+	for (auto& pt : points)
+		pt = Shapes::Point{position(gen), position(gen)};
+
+	std::cout << "\nspatial index over " << shape_count << " shapes:\n";
+
+	Shapes::SpatialGrid grid{area, 256};
+	auto [first_size, first_build_time] = measure([&] { grid.rebuild(boxes); return grid.size(); });
+	auto [size, rebuild_time] = measure([&] { grid.rebuild(boxes); return grid.size(); });
+	std::cout << "  build: " << first_build_time << ", rebuild: " << rebuild_time << "\n";
+
+	auto [grid_hits, grid_time] = measure([&] {
+		size_t hits = 0;
+		for (const auto& pt : points)
+			grid.query(Shapes::Box{pt, pt}, [&](auto) { ++hits; });
+		return hits;
+	});
+
+	const size_t scanned_point_count = 100;
+	auto [scan_hits, scan_time] = measure([&] {
+		size_t hits = 0;
+		for (size_t i = 0; i < scanned_point_count; ++i)
+			hits += std::ranges::count_if(boxes, [&](const Shapes::Box& box) { return box.contains(points[i]); });
+		return hits;
+	});
+
+	size_t grid_hits_for_scanned = 0;
+	for (size_t i = 0; i < scanned_point_count; ++i)
+		grid_hits_for_scanned += grid.hit_test(points[i]).size();
+
+	std::cout << "  hit test - SpatialGrid: " << grid_time.count() * 1000.0 / points.size() << " ns/query (" << grid_hits << " hits), "
+		<< "linear scan: " << scan_time.count() * 1000.0 / scanned_point_count << " ns/query"
+		<< (scan_hits == grid_hits_for_scanned ? "" : " - ERROR: results differ") << "\n";
+
+	auto [region_hits, region_time] = measure([&] {
+		size_t hits = 0;
+		for (const auto& pt : points)
+			grid.query(Shapes::Box{pt, {pt.x + 1'000, pt.y + 1'000}}, [&](auto) { ++hits; });
+		return hits;
+	});
+	std::cout << "  range query 1000x1000 - SpatialGrid: " << region_time.count() * 1000.0 / points.size() << " ns/query ("
+		<< region_hits / double(points.size()) << " shapes/query)\n";
+
+	// 1% of shapes dragged by a few pixels per frame
+	const int frame_count = 20;
+	std::uniform_int_distribution<size_t> shape_index{0, shape_count - 1};
+	std::vector<Shapes::SpatialGrid::Id> moving(shape_count / 100);
+	for (auto& id : moving)
+		id = static_cast<Shapes::SpatialGrid::Id>(shape_index(gen));
+
+	auto [frames, move_time] = measure([&] {
+		for (int frame = 0; frame < frame_count; ++frame)
+			for (auto id : moving)
+				grid.move(shapes[id], id, 3, -2);
+		return frame_count;
+	});
+	std::cout << "  move & update " << moving.size() << " shapes x " << frame_count << " frames: "
+		<< move_time.count() * 1000.0 / (moving.size() * frame_count) << " ns/shape\n";
+
+	size_t stale_boxes = 0;
+	for (auto id : moving)
+	{
+		const auto hits = grid.hit_test(Shapes::bounds(shapes[id]).min);
+		stale_boxes += std::ranges::find(hits, id) == hits.end();
+	}
+	if (stale_boxes > 0)
+		std::cout << "  ERROR: " << stale_boxes << " moved shapes not found\n";
+}
+
+void benchmark_batched_redraw()
+{
+	const size_t shape_count = 1'000'000;
+	const size_t moving_count = shape_count / 100;
+	const int frame_count = 20;
+
+	Shapes::BatchedRenderer renderer;
+	std::vector<Shapes::AnyShape> shapes;
+	shapes.reserve(shape_count);
+	generate_shapes(shape_count, [&](const auto& shape) {
+		renderer.add(shape);
+		shapes.push_back(shape);
+	});
+
+	// stand-in for rasterization - the output depends on every drawn shape
+	long long checksum = 0;
+	auto draw_shape = [&](const Shapes::AnyShape& shape) {
+		const Shapes::Point pt = Shapes::coord(shape);
+		checksum += pt.x ^ pt.y;
+	};
+
+	renderer.render_frame(draw_shape); // first frame draws everything
+
+	std::mt19937 gen{7};
+	std::uniform_int_distribution<Shapes::BatchedRenderer::Id> shape_index{0, static_cast<Shapes::BatchedRenderer::Id>(shape_count - 1)};
+	std::vector<Shapes::BatchedRenderer::Id> moving(moving_count);
+	for (auto& id : moving)
+		id = shape_index(gen);
+
+	auto [full_drawn, full_time] = measure([&] {
+		size_t drawn = 0;
+		for (int frame = 0; frame < frame_count; ++frame)
+		{
+			for (auto id : moving)
+				Shapes::move(shapes[id], 1, 1);
+			for (const auto& shape : shapes)
+				draw_shape(shape);
+			drawn += shapes.size();
+		}
+		return drawn;
+	});
+
+	auto [batched_drawn, batched_time] = measure([&] {
+		size_t drawn = 0;
+		for (int frame = 0; frame < frame_count; ++frame)
+		{
+			for (auto id : moving)
+				renderer.move(id, 1, 1);
+			drawn += renderer.render_frame(draw_shape);
+		}
+		return drawn;
+	});
+
+	std::cout << "\nredraw " << shape_count << " shapes with " << moving_count << " moving x " << frame_count << " frames (checksum " << checksum << "):\n"
+		<< "  redraw all:      " << full_time.count() / 1000.0 / frame_count << " ms/frame, " << full_drawn / frame_count << " shapes drawn/frame\n"
+		<< "  BatchedRenderer: " << batched_time.count() / 1000.0 / frame_count << " ms/frame, " << batched_drawn / frame_count << " shapes drawn/frame\n";
+
+	for (auto id : moving)
+		if (Shapes::coord(renderer.shape(id)).x != Shapes::coord(shapes[id]).x)
+		{
+			std::cout << "  ERROR: BatchedRenderer lost a move\n";
+			break;
+		}
+}
+
+void benchmark_bulk_transforms()
+{
+	const size_t shape_count = 2'000'000;
+	const int repeat_count = 10;
+
+	std::vector<Shapes::AnyShape> shapes;
+	shapes.reserve(shape_count);
+	generate_shapes(shape_count, [&](const auto& shape) { shapes.push_back(shape); });
+
+	std::cout << "\nbulk transforms of " << shape_count << " shapes:\n";
+
+	auto report = [&](const std::string& name, const auto& policy) {
+		auto [translated, translate_time] = measure([&] {
+			for (int i = 0; i < repeat_count; ++i)
+				Shapes::translate_all(policy, shapes, 1, -1);
+			return repeat_count;
+		});
+
+		auto [scaled, scale_time] = measure([&] {
+			for (int i = 0; i < repeat_count; ++i)
+				Shapes::scale_all(policy, shapes, i % 2 == 0 ? 2.0 : 0.5);
+			return repeat_count;
+		});
+
+		auto [box, box_time] = measure([&] {
+			std::optional<Shapes::Box> box;
+			for (int i = 0; i < repeat_count; ++i)
+				box = Shapes::bounding_box_of(policy, shapes);
+			return box;
+		});
+
+		auto per_shape = [&](std::chrono::microseconds time) { return time.count() * 1000.0 / (shape_count * repeat_count); };
+
+		std::cout << "  " << name << "translate_all: " << per_shape(translate_time) << " ns/shape, scale_all: " << per_shape(scale_time)
+			<< " ns/shape, bounding_box_of: " << per_shape(box_time) << " ns/shape - [" << box->min << ", " << box->max << "]\n";
+	};
+
+	report("std::execution::seq:     ", std::execution::seq);
+	report("std::execution::par:     ", std::execution::par);
+
+	for (unsigned int thread_count = 1; thread_count <= std::max(4u, std::thread::hardware_concurrency()); thread_count *= 2)
+		report("ChunkedPolicy{" + std::to_string(thread_count) + "}:" + std::string(thread_count < 10 ? 8 : 7, ' '), Shapes::ChunkedPolicy{thread_count});
+}
+
 int main()
 {
 	Shapes::ShapeFactory& shape_factory = Shapes::SingletonShapeFactory::instance();
@@ -15,4 +497,23 @@ int main()
 	sq.draw();
 	sq.move(50, 20);
 	sq.draw();
-}
\ No newline at end of file
+
+	Shapes::ShapeBatch batch;
+	batch.add(Shapes::Rectangle{10, 20, 30, 40});
+	batch.add(sq);
+	batch.move_all(5, 5);
+	batch.draw_all();
+
+	std::vector<Shapes::AnyShape> any_shapes = {Shapes::Rectangle{10, 20, 30, 40}, sq};
+	Shapes::move_all(any_shapes, -5, -5);
+	Shapes::draw_all(any_shapes);
+
+	benchmark_move_all();
+	benchmark_any_shape();
+	benchmark_factory_allocations();
+	benchmark_factory_lookup();
+	benchmark_singleton_access();
+	benchmark_spatial_index();
+	benchmark_batched_redraw();
+	benchmark_bulk_transforms();
+}
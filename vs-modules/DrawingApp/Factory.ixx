@@ -3,10 +3,11 @@ export module Factory;
 import std;
 
 export 
-template <typename TProduct, typename TId = std::string, typename TCreator = std::function<std::unique_ptr<TProduct>()>>
+template <typename TProduct, typename TId = std::string, typename TCreator = std::function<std::unique_ptr<TProduct>()>,
+    typename THash = std::hash<TId>, typename TKeyEqual = std::equal_to<TId>>
 class GenericFactory
 {
-    std::unordered_map<TId, TCreator> creators_;
+    std::unordered_map<TId, TCreator, THash, TKeyEqual> creators_;
 
 public:
     bool register_creator(TId id, TCreator creator)
@@ -17,10 +18,294 @@ public:
         return is_inserted;
     }
 
-    std::unique_ptr<TProduct> create(const TId& id) const
+    // returns whatever the creator returns - std::unique_ptr<TProduct> for the default creator
+    std::invoke_result_t<const TCreator&> create(const TId& id) const
     {
         auto& creator = creators_.at(id);
 
         return creator();
     }
-};
\ No newline at end of file
+
+    // lookup by a key of another type (e.g. std::string_view for std::string ids) - no TId is built
+    template <typename TKey>
+        requires requires { typename THash::is_transparent; typename TKeyEqual::is_transparent; }
+    std::invoke_result_t<const TCreator&> create(const TKey& id) const
+    {
+        auto it = creators_.find(id);
+        if (it == creators_.end())
+            throw std::out_of_range{"GenericFactory - unknown id"};
+
+        return it->second();
+    }
+};
+
+// fixed-size slots for objects of type T - freed slots are reused, memory goes back to the system with the pool
+export
+template <typename T>
+class ObjectPool
+{
+    union Slot
+    {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    Slot* free_list_ = nullptr;
+    std::size_t chunk_size_;
+
+    void grow()
+    {
+        auto& chunk = chunks_.emplace_back(std::make_unique_for_overwrite<Slot[]>(chunk_size_));
+
+        for (std::size_t i = chunk_size_; i-- > 0;)
+        {
+            chunk[i].next = free_list_;
+            free_list_ = &chunk[i];
+        }
+    }
+
+public:
+    explicit ObjectPool(std::size_t chunk_size = 256)
+        : chunk_size_{std::max<std::size_t>(chunk_size, 1)}
+    {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... TArgs>
+    T* create(TArgs&&... args)
+    {
+        if (!free_list_)
+            grow();
+
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+
+        try
+        {
+            return ::new (static_cast<void*>(slot->storage)) T(std::forward<TArgs>(args)...);
+        }
+        catch (...)
+        {
+            slot->next = free_list_;
+            free_list_ = slot;
+            throw;
+        }
+    }
+
+    void destroy(T* object) noexcept
+    {
+        object->~T();
+
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = free_list_;
+        free_list_ = slot;
+    }
+};
+
+// returns an object created as some T derived from TProduct to its ObjectPool<T>
+export
+template <typename TProduct>
+class PoolDeleter
+{
+    void (*destroy_)(void* pool, TProduct* product) = nullptr;
+    void* pool_ = nullptr;
+
+public:
+    PoolDeleter() = default;
+
+    template <typename T>
+    explicit PoolDeleter(ObjectPool<T>& pool) noexcept
+        : destroy_{[](void* pool, TProduct* product) { static_cast<ObjectPool<T>*>(pool)->destroy(static_cast<T*>(product)); }}
+        , pool_{&pool}
+    {}
+
+    void operator()(TProduct* product) const noexcept
+    {
+        destroy_(pool_, product);
+    }
+};
+
+export
+template <typename TProduct>
+using PooledPtr = std::unique_ptr<TProduct, PoolDeleter<TProduct>>;
+
+// creator for GenericFactory - objects come from a pool owned by the creator, so create() does not call operator new
+// in steady state; products must be destroyed before the factory & pools are not thread-safe
+export
+template <typename TProduct>
+class PooledCreator
+{
+    std::shared_ptr<void> pool_;
+    PooledPtr<TProduct> (*create_)(void* pool);
+
+    PooledCreator(std::shared_ptr<void> pool, PooledPtr<TProduct> (*create)(void*))
+        : pool_{std::move(pool)}
+        , create_{create}
+    {}
+
+public:
+    template <typename T>
+    static PooledCreator for_type(std::size_t chunk_size = 256)
+    {
+        return PooledCreator{std::make_shared<ObjectPool<T>>(chunk_size), [](void* pool) {
+            auto& typed_pool = *static_cast<ObjectPool<T>*>(pool);
+            return PooledPtr<TProduct>{typed_pool.create(), PoolDeleter<TProduct>{typed_pool}};
+        }};
+    }
+
+    PooledPtr<TProduct> operator()() const
+    {
+        return create_(pool_.get());
+    }
+};
+
+// perfect hash over ids known at compile time - a seed without collisions is searched for by the compiler
+export
+template <std::size_t N>
+class PerfectHash
+{
+    static constexpr std::size_t table_size = std::bit_ceil(2 * N); // at most half full - a seed is found quickly
+    static constexpr std::size_t empty_slot = N;
+
+    std::array<std::string_view, N> ids_;
+    std::array<std::size_t, table_size> slots_{};
+    std::uint64_t seed_ = 0;
+
+    // little-endian load of Size bytes - a single load at run time, byte by byte during constant evaluation
+    template <std::size_t Size>
+    static constexpr std::uint64_t read(const char* data) noexcept
+    {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+        {
+            std::conditional_t<Size == 8, std::uint64_t, std::uint32_t> word;
+            std::memcpy(&word, data, Size);
+            return word;
+        }
+
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < Size; ++i)
+            word |= std::uint64_t{static_cast<unsigned char>(data[i])} << (8 * i);
+
+        return word;
+    }
+
+    // constant time - length, first & last 8 bytes (overlapping for short ids); ids differing only in the middle
+    // have no perfect hash, which is reported when the table is built
+    static constexpr std::uint64_t hash(std::string_view id, std::uint64_t seed) noexcept
+    {
+        const char* data = id.data();
+        const std::size_t size = id.size();
+
+        std::uint64_t word = 0;
+        if (size >= 8)
+            word = read<8>(data) ^ std::rotl(read<8>(data + size - 8), 32);
+        else if (size >= 4)
+            word = read<4>(data) << 32 | read<4>(data + size - 4);
+        else if (size > 0)
+            word = std::uint64_t{static_cast<unsigned char>(data[0])} << 16
+                | std::uint64_t{static_cast<unsigned char>(data[size / 2])} << 8
+                | static_cast<unsigned char>(data[size - 1]);
+
+        constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+        std::uint64_t hash = (word ^ seed) * multiplier;
+        hash = (hash ^ (hash >> 32) ^ size) * multiplier; // size mixed in separately - cannot cancel out bits of word
+        return hash ^ (hash >> 32);
+    }
+
+public:
+    consteval PerfectHash(const std::array<std::string_view, N>& ids)
+        : ids_{ids}
+    {
+        for (std::size_t i = 0; i < N; ++i)
+            for (std::size_t j = i + 1; j < N; ++j)
+                if (ids_[i] == ids_[j])
+                    throw "duplicated id"; // not a constant expression - compilation fails
+
+        for (std::uint64_t seed = 0; seed < 100'000; ++seed)
+        {
+            slots_.fill(empty_slot);
+
+            bool has_collision = false;
+            for (std::size_t i = 0; i < N && !has_collision; ++i)
+            {
+                std::size_t& slot = slots_[hash(ids_[i], seed) & (table_size - 1)];
+                has_collision = slot != empty_slot;
+                slot = i;
+            }
+
+            if (!has_collision)
+            {
+                seed_ = seed;
+                return;
+            }
+        }
+
+        throw "no perfect hash found";
+    }
+
+    // one hash & one string comparison
+    constexpr std::optional<std::size_t> find(std::string_view id) const noexcept
+    {
+        const std::size_t index = slots_[hash(id, seed_) & (table_size - 1)];
+
+        if (index != empty_slot && ids_[index] == id)
+            return index;
+
+        return std::nullopt;
+    }
+
+    constexpr std::size_t size() const noexcept
+    {
+        return N;
+    }
+};
+
+// GenericFactory with a fixed set of ids resolved by a PerfectHash - other ids go to the dynamic map
+export
+template <typename TProduct, std::size_t N, typename TCreator = std::function<std::unique_ptr<TProduct>()>>
+class StaticFactory
+{
+    struct IdHash
+    {
+        using is_transparent = void; // lookup with std::string_view - no std::string per create()
+
+        std::size_t operator()(std::string_view id) const noexcept
+        {
+            return std::hash<std::string_view>{}(id);
+        }
+    };
+
+    PerfectHash<N> static_ids_;
+    std::array<std::optional<TCreator>, N> static_creators_;
+    GenericFactory<TProduct, std::string, TCreator, IdHash, std::equal_to<>> dynamic_creators_;
+
+public:
+    explicit StaticFactory(const PerfectHash<N>& static_ids)
+        : static_ids_{static_ids}
+    {}
+
+    bool register_creator(std::string_view id, TCreator creator)
+    {
+        if (auto index = static_ids_.find(id))
+        {
+            if (static_creators_[*index])
+                return false;
+
+            static_creators_[*index].emplace(std::move(creator));
+            return true;
+        }
+
+        return dynamic_creators_.register_creator(std::string{id}, std::move(creator));
+    }
+
+    std::invoke_result_t<const TCreator&> create(std::string_view id) const
+    {
+        if (auto index = static_ids_.find(id); index && static_creators_[*index])
+            return (*static_creators_[*index])();
+
+        return dynamic_creators_.create(id); // throws std::out_of_range for an unknown id
+    }
+};
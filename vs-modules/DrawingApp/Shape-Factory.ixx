@@ -3,10 +3,28 @@ export module Shapes:Factory;
 import Factory;
 import Singleton;
 import :Base;
+import :Rectangle;
+import :Square;
+import std;
 
 namespace Shapes
 {
 	export using ShapeFactory = GenericFactory<Shape>;
 
-	export using SingletonShapeFactory = Singleton::SingletonHolder<ShapeFactory>;
+	// instance() is called on hot paths - after the first call in a thread it costs one thread-local load
+	export using SingletonShapeFactory = Singleton::SingletonHolder<ShapeFactory, Singleton::ThreadLocalCached>;
+
+	// creates shapes in per-type object pools - register with PooledShapeCreator::for_type<Rectangle>()
+	export using PooledShapeCreator = PooledCreator<Shape>;
+
+	export using PooledShapePtr = PooledPtr<Shape>;
+
+	export using PooledShapeFactory = GenericFactory<Shape, std::string, PooledShapeCreator>;
+
+	// ids of the shapes built into the module - resolved by a perfect hash computed at compile time
+	export inline constexpr PerfectHash<2> builtin_shape_ids{{Rectangle::id, Square::id}};
+
+	export using StaticShapeFactory = StaticFactory<Shape, builtin_shape_ids.size()>;
+
+	export using StaticPooledShapeFactory = StaticFactory<Shape, builtin_shape_ids.size(), PooledShapeCreator>;
 }
\ No newline at end of file
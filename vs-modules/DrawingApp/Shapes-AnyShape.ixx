@@ -0,0 +1,50 @@
+export module Shapes:AnyShape;
+
+import :Point;
+import :Rectangle;
+import :Square;
+
+import std;
+
+export
+namespace Shapes
+{
+	template <typename T>
+	concept MovableDrawable = requires(T& shape, const T& const_shape, int d) {
+		shape.move(d, d);
+		const_shape.draw();
+		{ const_shape.coord() } -> std::convertible_to<Point>;
+	};
+
+	// closed set of shapes stored by value - no heap allocation, dispatch by std::visit instead of a vtable
+	using AnyShape = std::variant<Rectangle, Square>;
+
+	static_assert(MovableDrawable<Rectangle> && MovableDrawable<Square>);
+
+	inline void move(AnyShape& shape, int dx, int dy)
+	{
+		std::visit([dx, dy](MovableDrawable auto& s) { s.move(dx, dy); }, shape);
+	}
+
+	inline void draw(const AnyShape& shape)
+	{
+		std::visit([](const MovableDrawable auto& s) { s.draw(); }, shape);
+	}
+
+	inline Point coord(const AnyShape& shape)
+	{
+		return std::visit([](const MovableDrawable auto& s) { return s.coord(); }, shape);
+	}
+
+	inline void move_all(std::span<AnyShape> shapes, int dx, int dy)
+	{
+		for (auto& shape : shapes)
+			move(shape, dx, dy);
+	}
+
+	inline void draw_all(std::span<const AnyShape> shapes)
+	{
+		for (const auto& shape : shapes)
+			draw(shape);
+	}
+}
@@ -18,6 +18,15 @@ namespace Shapes
     class ShapeBase : public Shape
     {
         Point coord_; // composition
+        std::uint64_t generation_ = 0;
+
+    protected:
+        // to be called by every modifier of a derived class
+        void touch() noexcept
+        {
+            ++generation_;
+        }
+
     public:
         Point coord() const
         {
@@ -27,6 +36,7 @@ namespace Shapes
         void set_coord(const Point& pt)
         {
             coord_ = pt;
+            touch();
         }
 
         ShapeBase(int x = 0, int y = 0)
@@ -36,6 +46,13 @@ namespace Shapes
         void move(int dx, int dy) override
         {
             coord_.translate(dx, dy);
+            touch();
+        }
+
+        // changes with every modification - a copy has the generation of its source
+        std::uint64_t generation() const noexcept
+        {
+            return generation_;
         }
     };
 }
\ No newline at end of file
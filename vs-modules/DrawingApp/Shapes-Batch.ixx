@@ -0,0 +1,103 @@
+export module Shapes:Batch;
+
+import :Point;
+import :Rectangle;
+import :Square;
+
+import std;
+
+namespace Shapes
+{
+	// contiguous loop without dependencies between iterations - vectorized by the compiler
+	void translate(std::span<int> values, int delta) noexcept
+	{
+		for (int& value : values)
+			value += delta;
+	}
+}
+
+export
+namespace Shapes
+{
+	// shapes stored as struct-of-arrays grouped by kind - no heap object & no virtual call per shape
+	class ShapeBatch
+	{
+		struct Rectangles
+		{
+			std::vector<int> xs, ys, widths, heights;
+		} rectangles_;
+
+		struct Squares
+		{
+			std::vector<int> xs, ys, sizes;
+		} squares_;
+
+	public:
+		void add(const Rectangle& rect)
+		{
+			rectangles_.xs.push_back(rect.coord().x);
+			rectangles_.ys.push_back(rect.coord().y);
+			rectangles_.widths.push_back(rect.width());
+			rectangles_.heights.push_back(rect.height());
+		}
+
+		void add(const Square& square)
+		{
+			squares_.xs.push_back(square.coord().x);
+			squares_.ys.push_back(square.coord().y);
+			squares_.sizes.push_back(square.size());
+		}
+
+		void reserve(std::size_t rectangle_count, std::size_t square_count)
+		{
+			for (auto* values : {&rectangles_.xs, &rectangles_.ys, &rectangles_.widths, &rectangles_.heights})
+				values->reserve(rectangle_count);
+
+			for (auto* values : {&squares_.xs, &squares_.ys, &squares_.sizes})
+				values->reserve(square_count);
+		}
+
+		std::size_t rectangle_count() const
+		{
+			return rectangles_.xs.size();
+		}
+
+		std::size_t square_count() const
+		{
+			return squares_.xs.size();
+		}
+
+		std::size_t size() const
+		{
+			return rectangle_count() + square_count();
+		}
+
+		Rectangle rectangle(std::size_t index) const
+		{
+			return Rectangle{rectangles_.xs[index], rectangles_.ys[index], rectangles_.widths[index], rectangles_.heights[index]};
+		}
+
+		Square square(std::size_t index) const
+		{
+			return Square{squares_.xs[index], squares_.ys[index], squares_.sizes[index]};
+		}
+
+		// touches only the coordinate arrays
+		void move_all(int dx, int dy) noexcept
+		{
+			translate(rectangles_.xs, dx);
+			translate(rectangles_.ys, dy);
+			translate(squares_.xs, dx);
+			translate(squares_.ys, dy);
+		}
+
+		void draw_all() const
+		{
+			for (std::size_t i = 0; i < rectangle_count(); ++i)
+				rectangle(i).draw();
+
+			for (std::size_t i = 0; i < square_count(); ++i)
+				square(i).draw();
+		}
+	};
+}
@@ -0,0 +1,162 @@
+export module Shapes:Bulk;
+
+import :Point;
+import :Rectangle;
+import :Square;
+import :AnyShape;
+import :SpatialIndex;
+
+import std;
+
+export
+namespace Shapes
+{
+	// splits a collection into one contiguous chunk per thread - chunks start on cache line boundaries where the items
+	// allow it (their size & address, as for AnyShape), so no cache line is written by two threads
+	struct ChunkedPolicy
+	{
+		unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	};
+
+	template <typename TPolicy>
+	concept StdExecutionPolicy = std::is_execution_policy_v<std::remove_cvref_t<TPolicy>>;
+
+	// scales coordinates relative to origin & sizes - results are rounded to the nearest integer
+	inline void scale(Rectangle& rect, double factor, const Point& origin = {})
+	{
+		const Point pt = rect.coord();
+		rect.set_coord({static_cast<int>(std::lround(origin.x + (pt.x - origin.x) * factor)),
+			static_cast<int>(std::lround(origin.y + (pt.y - origin.y) * factor))});
+		rect.set_width(static_cast<int>(std::lround(rect.width() * factor)));
+		rect.set_height(static_cast<int>(std::lround(rect.height() * factor)));
+	}
+
+	inline void scale(Square& square, double factor, const Point& origin = {})
+	{
+		const Point pt = square.coord();
+		square.set_coord({static_cast<int>(std::lround(origin.x + (pt.x - origin.x) * factor)),
+			static_cast<int>(std::lround(origin.y + (pt.y - origin.y) * factor))});
+		square.set_size(static_cast<int>(std::lround(square.size() * factor)));
+	}
+
+	inline void scale(AnyShape& shape, double factor, const Point& origin = {})
+	{
+		std::visit([&](auto& s) { scale(s, factor, origin); }, shape);
+	}
+
+	// smallest box containing both boxes
+	constexpr Box merge(const Box& a, const Box& b) noexcept
+	{
+		return Box{{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)}, {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)}};
+	}
+}
+
+namespace Shapes
+{
+	// fixed - std::hardware_destructive_interference_size changes with compiler flags
+	constexpr std::size_t cache_line_size = 64;
+
+	// identity of merge()
+	constexpr Box empty_box{{std::numeric_limits<int>::max(), std::numeric_limits<int>::max()},
+		{std::numeric_limits<int>::min(), std::numeric_limits<int>::min()}};
+
+	// calls process_chunk(chunk_index, chunk) - the calling thread takes the first chunk
+	template <typename T, typename F>
+	void for_each_chunk(const ChunkedPolicy& policy, std::span<T> items, F&& process_chunk)
+	{
+		// the items in lcm(cache_line_size, sizeof(T)) bytes - the smallest step between two items starting a cache line
+		constexpr std::size_t items_per_step = std::lcm(cache_line_size, sizeof(T)) / sizeof(T);
+
+		// first item starting a cache line - chunks start at it plus multiples of items_per_step
+		// (none for items not aligned to gcd(cache_line_size, sizeof(T)) - the chunks just start at multiples of items_per_step)
+		std::size_t first_aligned = 0;
+		while (first_aligned < items_per_step && reinterpret_cast<std::uintptr_t>(items.data() + first_aligned) % cache_line_size != 0)
+			++first_aligned;
+		if (first_aligned == items_per_step)
+			first_aligned = 0;
+
+		const std::size_t thread_count = std::clamp<std::size_t>(policy.thread_count, 1, std::max<std::size_t>(items.size(), 1));
+		std::size_t chunk_size = (items.size() + thread_count - 1) / thread_count;
+		chunk_size = (chunk_size + items_per_step - 1) / items_per_step * items_per_step;
+
+		const std::size_t first_chunk_size = std::min(first_aligned + chunk_size, items.size()); // takes the items before the first cache line
+
+		std::vector<std::jthread> threads;
+		threads.reserve(thread_count - 1);
+
+		std::size_t chunk_index = 1;
+		for (std::size_t first = first_chunk_size; first < items.size(); first += chunk_size, ++chunk_index)
+			threads.emplace_back([&process_chunk, chunk = items.subspan(first, std::min(chunk_size, items.size() - first)), chunk_index] {
+				process_chunk(chunk_index, chunk);
+			});
+
+		process_chunk(0, items.first(first_chunk_size));
+	} // joins threads
+}
+
+export
+namespace Shapes
+{
+	template <StdExecutionPolicy TPolicy>
+	void translate_all(TPolicy&& policy, std::span<AnyShape> shapes, int dx, int dy)
+	{
+		std::for_each(std::forward<TPolicy>(policy), shapes.begin(), shapes.end(), [dx, dy](AnyShape& shape) { move(shape, dx, dy); });
+	}
+
+	inline void translate_all(const ChunkedPolicy& policy, std::span<AnyShape> shapes, int dx, int dy)
+	{
+		for_each_chunk(policy, shapes, [dx, dy](std::size_t, std::span<AnyShape> chunk) { move_all(chunk, dx, dy); });
+	}
+
+	template <StdExecutionPolicy TPolicy>
+	void scale_all(TPolicy&& policy, std::span<AnyShape> shapes, double factor, const Point& origin = {})
+	{
+		std::for_each(std::forward<TPolicy>(policy), shapes.begin(), shapes.end(), [factor, origin](AnyShape& shape) { scale(shape, factor, origin); });
+	}
+
+	inline void scale_all(const ChunkedPolicy& policy, std::span<AnyShape> shapes, double factor, const Point& origin = {})
+	{
+		for_each_chunk(policy, shapes, [factor, origin](std::size_t, std::span<AnyShape> chunk) {
+			for (auto& shape : chunk)
+				scale(shape, factor, origin);
+		});
+	}
+
+	// std::nullopt for no shapes
+	template <StdExecutionPolicy TPolicy>
+	std::optional<Box> bounding_box_of(TPolicy&& policy, std::span<const AnyShape> shapes)
+	{
+		if (shapes.empty())
+			return std::nullopt;
+
+		return std::transform_reduce(std::forward<TPolicy>(policy), shapes.begin(), shapes.end(), empty_box, merge,
+			[](const AnyShape& shape) { return bounds(shape); });
+	}
+
+	// every thread reduces its chunk to a local box - the boxes are merged at the end
+	inline std::optional<Box> bounding_box_of(const ChunkedPolicy& policy, std::span<const AnyShape> shapes)
+	{
+		if (shapes.empty())
+			return std::nullopt;
+
+		struct alignas(cache_line_size) ChunkBox
+		{
+			Box box = empty_box;
+		};
+
+		std::vector<ChunkBox> chunk_boxes(std::max(policy.thread_count, 1u)); // at most one chunk per thread
+
+		for_each_chunk(policy, shapes, [&chunk_boxes](std::size_t chunk_index, std::span<const AnyShape> chunk) {
+			Box box = empty_box;
+			for (const auto& shape : chunk)
+				box = merge(box, bounds(shape));
+			chunk_boxes[chunk_index].box = box;
+		});
+
+		Box box = empty_box;
+		for (const auto& chunk_box : chunk_boxes)
+			box = merge(box, chunk_box.box);
+
+		return box;
+	}
+}
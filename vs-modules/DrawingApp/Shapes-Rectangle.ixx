@@ -7,7 +7,7 @@ import std;
 export
 namespace Shapes
 {
-	class Rectangle : public ShapeBase
+	class Rectangle final : public ShapeBase // final - calls on a Rectangle object are not virtual
 	{
 		int width_, height_;
 
@@ -24,6 +24,7 @@ namespace Shapes
 		void set_width(int w)
 		{
 			width_ = w;
+			touch();
 		}
 
 		int height() const
@@ -34,6 +35,7 @@ namespace Shapes
 		void set_height(int h)
 		{
 			height_ = h;
+			touch();
 		}
 
 		void draw() const override;
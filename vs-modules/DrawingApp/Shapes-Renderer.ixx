@@ -0,0 +1,111 @@
+export module Shapes:Renderer;
+
+import :Rectangle;
+import :Square;
+import :AnyShape;
+
+import std;
+
+export
+namespace Shapes
+{
+	inline std::uint64_t generation(const AnyShape& shape)
+	{
+		return std::visit([](const auto& s) { return s.generation(); }, shape);
+	}
+
+	// owns the shapes of a scene & redraws only the ones changed since the last frame - changes go through update(),
+	// so a frame costs as much as the number of changed shapes, not the size of the scene
+	class BatchedRenderer
+	{
+	public:
+		using Id = std::uint32_t;
+
+	private:
+		std::vector<AnyShape> shapes_;
+		std::vector<std::uint64_t> drawn_generations_; // indexed by Id
+		std::vector<bool> is_dirty_;
+		std::vector<Id> dirty_ids_;
+
+		void mark_dirty(Id id)
+		{
+			if (!is_dirty_[id])
+			{
+				is_dirty_[id] = true;
+				dirty_ids_.push_back(id);
+			}
+		}
+
+	public:
+		Id add(AnyShape shape)
+		{
+			const Id id = static_cast<Id>(shapes_.size());
+			shapes_.push_back(std::move(shape));
+			drawn_generations_.push_back(generation(shapes_.back()));
+			is_dirty_.push_back(false);
+			mark_dirty(id); // not drawn yet
+
+			return id;
+		}
+
+		std::size_t size() const noexcept
+		{
+			return shapes_.size();
+		}
+
+		const AnyShape& shape(Id id) const
+		{
+			return shapes_[id];
+		}
+
+		std::span<const AnyShape> shapes() const noexcept
+		{
+			return shapes_;
+		}
+
+		// change(shape) may modify the shape through its public interface - generation tells if it did
+		template <std::invocable<AnyShape&> F>
+		void update(Id id, F&& change)
+		{
+			std::invoke(std::forward<F>(change), shapes_[id]);
+
+			if (generation(shapes_[id]) != drawn_generations_[id])
+				mark_dirty(id);
+		}
+
+		void move(Id id, int dx, int dy)
+		{
+			update(id, [dx, dy](AnyShape& shape) { Shapes::move(shape, dx, dy); });
+		}
+
+		// forces a redraw of all shapes in the next frame
+		void invalidate_all()
+		{
+			for (Id id = 0; id < shapes_.size(); ++id)
+				mark_dirty(id);
+		}
+
+		// calls draw_shape(shape) for every shape changed since the last frame; returns the number of drawn shapes
+		template <std::invocable<const AnyShape&> F>
+		std::size_t render_frame(F&& draw_shape)
+		{
+			const std::size_t drawn_count = dirty_ids_.size();
+
+			for (Id id : dirty_ids_)
+			{
+				std::invoke(draw_shape, std::as_const(shapes_[id]));
+				drawn_generations_[id] = generation(shapes_[id]);
+				is_dirty_[id] = false;
+			}
+
+			dirty_ids_.clear();
+
+			return drawn_count;
+		}
+
+		std::size_t render_frame()
+		{
+			return render_frame([](const AnyShape& shape) { draw(shape); });
+		}
+	};
+}
@@ -0,0 +1,216 @@
+export module Shapes:SpatialIndex;
+
+import :Point;
+import :Rectangle;
+import :Square;
+import :AnyShape;
+
+import std;
+
+export
+namespace Shapes
+{
+	// axis-aligned bounding box - edges included
+	struct Box
+	{
+		Point min, max;
+
+		constexpr bool contains(const Point& pt) const noexcept
+		{
+			return min.x <= pt.x && pt.x <= max.x && min.y <= pt.y && pt.y <= max.y;
+		}
+
+		constexpr bool intersects(const Box& other) const noexcept
+		{
+			return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+		}
+	};
+
+	inline Box bounds(const Rectangle& rect)
+	{
+		const Point pt = rect.coord();
+		const Point opposite{pt.x + rect.width(), pt.y + rect.height()};
+
+		return Box{{std::min(pt.x, opposite.x), std::min(pt.y, opposite.y)}, {std::max(pt.x, opposite.x), std::max(pt.y, opposite.y)}};
+	}
+
+	inline Box bounds(const Square& square)
+	{
+		return bounds(Rectangle{square.coord().x, square.coord().y, square.size(), square.size()});
+	}
+
+	inline Box bounds(const AnyShape& shape)
+	{
+		return std::visit([](const auto& s) { return bounds(s); }, shape);
+	}
+
+	// uniform grid over a fixed area - every shape is listed in the cells its box overlaps; boxes outside
+	// the area are clamped to the border cells, so they are still found (just less efficiently)
+	class SpatialGrid
+	{
+	public:
+		using Id = std::uint32_t;
+
+	private:
+		struct CellRange
+		{
+			int first_column, first_row, last_column, last_row;
+
+			bool operator==(const CellRange&) const = default;
+		};
+
+		Box area_;
+		int cell_size_;
+		int columns_, rows_;
+		std::vector<std::vector<Id>> cells_;
+		std::vector<Box> boxes_; // indexed by Id
+
+		int cell_index(long long coord, int origin, int count) const noexcept
+		{
+			return static_cast<int>(std::clamp((coord - origin) / cell_size_, 0LL, count - 1LL));
+		}
+
+		CellRange cell_range(const Box& box) const noexcept
+		{
+			return {cell_index(box.min.x, area_.min.x, columns_), cell_index(box.min.y, area_.min.y, rows_),
+				cell_index(box.max.x, area_.min.x, columns_), cell_index(box.max.y, area_.min.y, rows_)};
+		}
+
+		std::vector<Id>& cell(int column, int row)
+		{
+			return cells_[static_cast<std::size_t>(row) * columns_ + column];
+		}
+
+		const std::vector<Id>& cell(int column, int row) const
+		{
+			return cells_[static_cast<std::size_t>(row) * columns_ + column];
+		}
+
+		static bool contains(const CellRange& range, int column, int row) noexcept
+		{
+			return range.first_column <= column && column <= range.last_column && range.first_row <= row && row <= range.last_row;
+		}
+
+		void add_to_cells(Id id, const CellRange& range, const CellRange& except)
+		{
+			for (int row = range.first_row; row <= range.last_row; ++row)
+				for (int column = range.first_column; column <= range.last_column; ++column)
+					if (!contains(except, column, row))
+						cell(column, row).push_back(id);
+		}
+
+		void remove_from_cells(Id id, const CellRange& range, const CellRange& except)
+		{
+			for (int row = range.first_row; row <= range.last_row; ++row)
+				for (int column = range.first_column; column <= range.last_column; ++column)
+					if (!contains(except, column, row))
+					{
+						auto& ids = cell(column, row);
+						auto it = std::find(ids.begin(), ids.end(), id);
+						*it = ids.back(); // order within a cell does not matter
+						ids.pop_back();
+					}
+		}
+
+		static constexpr CellRange no_cells{0, 0, -1, -1};
+
+	public:
+		// cell_size of 1-2x the typical shape extent - smaller cells list big shapes many times, bigger cells give more candidates
+		SpatialGrid(const Box& area, int cell_size)
+			: area_{area}
+			, cell_size_{std::max(cell_size, 1)}
+			, columns_{static_cast<int>((static_cast<long long>(area.max.x) - area.min.x) / cell_size_ + 1)}
+			, rows_{static_cast<int>((static_cast<long long>(area.max.y) - area.min.y) / cell_size_ + 1)}
+			, cells_(static_cast<std::size_t>(columns_) * rows_)
+		{}
+
+		std::size_t size() const noexcept
+		{
+			return boxes_.size();
+		}
+
+		const Box& box(Id id) const
+		{
+			return boxes_[id];
+		}
+
+		// ids are assigned in order of insertion: 0, 1, 2...
+		Id insert(const Box& box)
+		{
+			const Id id = static_cast<Id>(boxes_.size());
+			boxes_.push_back(box);
+			add_to_cells(id, cell_range(box), no_cells);
+
+			return id;
+		}
+
+		// incremental - only cells that the box enters or leaves are touched; a small move usually touches none
+		void update(Id id, const Box& box)
+		{
+			const CellRange old_range = cell_range(boxes_[id]);
+			const CellRange new_range = cell_range(box);
+			boxes_[id] = box;
+
+			if (old_range == new_range)
+				return;
+
+			remove_from_cells(id, old_range, new_range);
+			add_to_cells(id, new_range, old_range);
+		}
+
+		// moves the shape & updates its entry
+		template <MovableDrawable TShape>
+		void move(TShape& shape, Id id, int dx, int dy)
+		{
+			shape.move(dx, dy);
+			update(id, bounds(shape));
+		}
+
+		void move(AnyShape& shape, Id id, int dx, int dy)
+		{
+			Shapes::move(shape, dx, dy);
+			update(id, bounds(shape));
+		}
+
+		// replaces all entries - ids become indexes of boxes; cells keep their capacity, so a rebuild of a similar
+		// scene does not allocate
+		void rebuild(std::span<const Box> boxes)
+		{
+			for (auto& ids : cells_)
+				ids.clear();
+
+			boxes_.assign(boxes.begin(), boxes.end());
+			for (Id id = 0; id < boxes_.size(); ++id)
+				add_to_cells(id, cell_range(boxes_[id]), no_cells);
+		}
+
+		// calls on_hit(id) once for every box intersecting the region
+		template <typename F>
+		void query(const Box& region, F&& on_hit) const
+		{
+			const CellRange range = cell_range(region);
+
+			for (int row = range.first_row; row <= range.last_row; ++row)
+				for (int column = range.first_column; column <= range.last_column; ++column)
+					for (Id id : cell(column, row))
+					{
+						const Box& box = boxes_[id];
+						if (!box.intersects(region))
+							continue;
+
+						// a box overlapping many cells of the region is reported only from the cell of the intersection's corner
+						const Point corner{std::max(box.min.x, region.min.x), std::max(box.min.y, region.min.y)};
+						if (cell_index(corner.x, area_.min.x, columns_) == column && cell_index(corner.y, area_.min.y, rows_) == row)
+							on_hit(id);
+					}
+		}
+
+		std::vector<Id> hit_test(const Point& pt) const
+		{
+			std::vector<Id> hits;
+			query(Box{pt, pt}, [&](Id id) { hits.push_back(id); });
+
+			return hits;
+		}
+	};
+}
@@ -45,3 +45,7 @@ void Square::draw() const
     rect_.draw();
 }
 
+std::uint64_t Square::generation() const noexcept
+{
+    return rect_.generation(); // every modifier forwards to rect_
+}
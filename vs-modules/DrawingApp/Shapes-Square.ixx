@@ -2,11 +2,12 @@ export module Shapes:Square;
 
 import :Base;
 import :Rectangle;
+import std;
 
 namespace Shapes
 {
     export
-    class Square : public Shape
+    class Square final : public Shape
     {
         Rectangle rect_;
 
@@ -26,5 +27,7 @@ namespace Shapes
         void draw() const override;
 
         void move(int dx, int dy) override;
+
+        std::uint64_t generation() const noexcept;
     };
 }
\ No newline at end of file
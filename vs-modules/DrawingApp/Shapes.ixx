@@ -4,4 +4,9 @@ export import :Point;
 export import :Base;
 export import :Factory;
 export import :Rectangle;
-export import :Square;
\ No newline at end of file
+export import :Square;
+export import :Batch;
+export import :AnyShape;
+export import :SpatialIndex;
+export import :Renderer;
+export import :Bulk;
\ No newline at end of file
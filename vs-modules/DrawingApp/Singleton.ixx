@@ -2,7 +2,51 @@ export module Singleton;
 
 export namespace Singleton
 {
+	// creation policies - a policy provides static T& instance()
+
+	// created on first use - thread-safe, but every call checks the guard variable (acquire load)
+	template <typename T>
+	struct LazyStatic
+	{
+		static T& instance()
+		{
+			static T unique_instance;
+
+			return unique_instance;
+		}
+	};
+
+	// created at compile time - no guard variable & no initialization order issues; T must be constant-initializable
+	template <typename T>
+	struct EagerConstinit
+	{
+		static T& instance() noexcept
+		{
+			return unique_instance;
+		}
+
+	private:
+		static constinit inline T unique_instance{};
+	};
+
+	// same instance as LazyStatic<T> - the guard variable is checked once per thread, then the address comes
+	// from a thread-local pointer (one plain load)
 	template <typename T>
+	struct ThreadLocalCached
+	{
+		static T& instance()
+		{
+			if (!cached_instance) [[unlikely]]
+				cached_instance = &LazyStatic<T>::instance();
+
+			return *cached_instance;
+		}
+
+	private:
+		static thread_local inline T* cached_instance = nullptr;
+	};
+
+	template <typename T, template <typename> class TCreationPolicy = LazyStatic>
 	class SingletonHolder
 	{
 	private:
@@ -15,9 +59,7 @@ export namespace Singleton
 
 		static T& instance()
 		{
-			static T unique_instance;
-
-			return unique_instance;
+			return TCreationPolicy<T>::instance();
 		}
 	};
 }
\ No newline at end of file
@@ -1,7 +1,26 @@
 #include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <random>
+#include <vector>
+#include <memory>
+#include <span>
+#include <algorithm>
 
 import Primes; // importing module Prime
 
+template <typename F>
+auto measure(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = f();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::pair{result, std::chrono::duration_cast<std::chrono::milliseconds>(end - start)};
+}
+
 int main()
 {
     std::cout << "check if 13 is prime: " << is_prime(13) << "\n";
@@ -19,4 +38,72 @@ int main()
     for (const uint32_t& n : my_primes)
         std::cout << n << " ";
     std::cout << "\n";
+
+    // benchmark: is_prime() for every number vs. segmented sieve
+    const uint32_t limit = 10'000'000;
+
+    auto [single_test_primes, single_test_time] = measure([limit] {
+        size_t count = 0;
+        for (uint32_t n = 2; n <= limit; ++n)
+            if (is_prime(n))
+                ++count;
+        return count;
+    });
+    std::cout << "\nis_prime() up to " << limit << ": " << single_test_primes << " primes in " << single_test_time << "\n";
+
+    auto [sieve_primes, sieve_time] = measure([limit] { return primes_up_to(limit).size(); });
+    std::cout << "Segmented sieve up to " << limit << ": " << sieve_primes << " primes in " << sieve_time << "\n";
+
+    auto [large_sieve_primes, large_sieve_time] = measure([] { return primes_up_to(500'000'000).size(); });
+    std::cout << "Segmented sieve up to 500000000: " << large_sieve_primes << " primes in " << large_sieve_time << "\n";
+
+    // num_threads == 0 - sieved on one thread
+    assert(count_primes(0, 1'000, 0) == 168);
+    assert(primes_in_range(0, 1'000, 0).size() == 168);
+
+    // benchmark: parallel counting in a window above 10^10
+    const uint64_t lo = 10'000'000'000, hi = lo + 200'000'000;
+
+    for (unsigned num_threads = 1; num_threads <= std::max(1u, std::thread::hardware_concurrency()); ++num_threads)
+    {
+        auto [count, time] = measure([=] { return count_primes(lo, hi, num_threads); });
+        std::cout << "count_primes in [" << lo << ", " << hi << ") with " << num_threads << " thread(s): " << count << " primes in " << time
+                  << " - " << (count * 1000.0 / std::max<long long>(1, time.count())) << " primes/s\n";
+    }
+
+    uint64_t checksum = 0;
+    auto [streamed, stream_time] = measure([&] {
+        uint64_t count = 0;
+        for_each_prime_parallel(lo, hi, [&](uint64_t p) { checksum ^= p; ++count; });
+        return count;
+    });
+    std::cout << "for_each_prime_parallel in order: " << streamed << " primes in " << stream_time << " (checksum: " << checksum << ")\n";
+
+    // benchmark: scalar vs. batched Miller-Rabin for random 64-bit numbers
+    std::mt19937_64 rnd_gen{42};
+    std::vector<uint64_t> numbers(1'000'000);
+    for (auto& n : numbers)
+        n = rnd_gen() | 1;
+
+    auto [scalar_primes, scalar_time] = measure([&] {
+        size_t count = 0;
+        for (uint64_t n : numbers)
+            count += IsPrime{}(n);
+        return count;
+    });
+    std::cout << "Scalar is_prime for " << numbers.size() << " random 64-bit numbers: " << scalar_primes << " primes in " << scalar_time << "\n";
+
+    auto results = std::make_unique<bool[]>(numbers.size());
+    auto [batch_primes, batch_time] = measure([&] {
+        IsPrime{}(numbers, std::span{results.get(), numbers.size()});
+        return std::count(results.get(), results.get() + numbers.size(), true);
+    });
+    std::cout << "Batched is_prime for " << numbers.size() << " random 64-bit numbers: " << batch_primes << " primes in " << batch_time << "\n";
+
+    // compressed compile-time table: mod 30 wheel bitmap vs. std::array of primes
+    constexpr auto& bitmap = prime_bitmap<500'000>;
+    std::cout << "\nprime_bitmap<500000>: " << bitmap.count() << " primes in " << sizeof(bitmap) << " bytes (std::array<uint32_t, "
+              << bitmap.count() << ">: " << bitmap.count() * sizeof(uint32_t) << " bytes)\n";
+    std::cout << "is 499979 prime: " << bitmap.is_prime(499'979) << ", pi(100000) = " << bitmap.rank(100'000)
+              << ", 10000th prime = " << bitmap.select(9'999) << "\n";
 }
\ No newline at end of file
@@ -1,48 +1,782 @@
 module; // global fragment module
 
+#include <cmath>
 #include <cstdint>
+#include <cstddef>
 #include <limits>
 #include <array>
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <span>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 export module Primes; // declare module Primes
 
-export constexpr bool is_prime(uint32_t n)
+//////////////////////////////////////////////////////////////////////////////
+// Deterministic Miller-Rabin test with Montgomery multiplication (not exported)
+
+namespace Montgomery
+{
+    // high 64 bits of a * b
+    constexpr uint64_t mul_hi(uint64_t a, uint64_t b)
+    {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+#if defined(_MSC_VER)
+        if (!std::is_constant_evaluated())
+            return __umulh(a, b);
+#endif
+        const uint64_t a_lo = a & 0xFFFF'FFFF, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xFFFF'FFFF, b_hi = b >> 32;
+
+        const uint64_t lo_lo = a_lo * b_lo;
+        const uint64_t hi_lo = a_hi * b_lo;
+        const uint64_t lo_hi = a_lo * b_hi;
+        const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFF'FFFF) + lo_hi;
+
+        return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+    }
+
+    // arithmetic modulo odd n on numbers in Montgomery form (x * 2^64 mod n)
+    struct Modulus
+    {
+        uint64_t n = 1;
+        uint64_t n_inv = 1; // n * n_inv == 1 (mod 2^64)
+        uint64_t one = 0;   // 2^64 mod n
+        uint64_t r2 = 0;    // 2^128 mod n
+
+        Modulus() = default;
+
+        constexpr explicit Modulus(uint64_t n)
+            : n{n}
+            , n_inv{n}
+            , one{(0 - n) % n}
+            , r2{one}
+        {
+            for (int i = 0; i < 5; ++i) // Newton's iteration doubles correct bits: 3, 6, 12, ..., 96
+                n_inv *= 2 - n * n_inv;
+
+            for (int i = 0; i < 64; ++i)
+                r2 = r2 >= n - r2 ? r2 - (n - r2) : r2 + r2;
+        }
+
+        // a * b * 2^-64 mod n for a, b < n
+        constexpr uint64_t mul(uint64_t a, uint64_t b) const
+        {
+            const uint64_t m = a * b * n_inv; // low 64 bits of a * b - m * n are zero
+            const uint64_t product_hi = mul_hi(a, b);
+            const uint64_t mn_hi = mul_hi(m, n);
+
+            return product_hi >= mn_hi ? product_hi - mn_hi : product_hi + (n - mn_hi);
+        }
+
+        constexpr uint64_t to_montgomery(uint64_t a) const
+        {
+            return mul(a % n, r2);
+        }
+
+        constexpr uint64_t minus_one() const
+        {
+            return n - one;
+        }
+    };
+} // namespace Montgomery
+
+namespace MillerRabin
+{
+    // bases giving a deterministic test for all n < 2^64 (J. Sinclair)
+    inline constexpr std::array<uint64_t, 7> witnesses = {2, 325, 9'375, 28'178, 450'775, 9'780'504, 1'795'265'022};
+
+    // trial division handles every n < 37 * 37
+    inline constexpr std::array<uint64_t, 12> small_primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+    enum class Result
+    {
+        prime,
+        composite,
+        unknown
+    };
+
+    constexpr Result trial_division(uint64_t n)
+    {
+        if (n < 2)
+            return Result::composite;
+
+        for (uint64_t p : small_primes)
+            if (n % p == 0)
+                return n == p ? Result::prime : Result::composite;
+
+        return n < small_primes.back() * small_primes.back() ? Result::prime : Result::unknown;
+    }
+
+    // n - odd, n > 37 * 37
+    constexpr bool is_strong_probable_prime(uint64_t n)
+    {
+        const Montgomery::Modulus mod{n};
+        const int s = std::countr_zero(n - 1);
+        const uint64_t d = (n - 1) >> s;
+
+        for (uint64_t a : witnesses)
+        {
+            if (a % n == 0)
+                continue;
+
+            const uint64_t base = mod.to_montgomery(a);
+            uint64_t x = mod.one;
+            for (int bit = std::bit_width(d) - 1; bit >= 0; --bit)
+            {
+                x = mod.mul(x, x);
+                if ((d >> bit) & 1)
+                    x = mod.mul(x, base);
+            }
+
+            if (x == mod.one || x == mod.minus_one())
+                continue;
+
+            bool is_witness_of_compositeness = true;
+            for (int i = 1; i < s && is_witness_of_compositeness; ++i)
+            {
+                x = mod.mul(x, x);
+                is_witness_of_compositeness = x != mod.minus_one();
+            }
+
+            if (is_witness_of_compositeness)
+                return false;
+        }
+
+        return true;
+    }
+
+    // strong probable prime test to base a of Lanes numbers in lockstep - interleaved
+    // multiplication chains hide the latency of 64-bit multiplies
+    template <size_t Lanes>
+    std::array<bool, Lanes> is_strong_probable_prime(const std::array<uint64_t, Lanes>& n, uint64_t a)
+    {
+        std::array<Montgomery::Modulus, Lanes> mod{};
+        std::array<int, Lanes> s{};
+        std::array<uint64_t, Lanes> d{};
+        std::array<uint64_t, Lanes> base{};
+        std::array<uint64_t, Lanes> x{};
+        int max_bit_width = 0;
+        int max_s = 0;
+
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            mod[lane] = Montgomery::Modulus{n[lane]};
+            s[lane] = std::countr_zero(n[lane] - 1);
+            d[lane] = (n[lane] - 1) >> s[lane];
+            base[lane] = mod[lane].to_montgomery(a);
+            x[lane] = mod[lane].one;
+            max_bit_width = std::max<int>(max_bit_width, std::bit_width(d[lane]));
+            max_s = std::max(max_s, s[lane]);
+        }
+
+        for (int bit = max_bit_width - 1; bit >= 0; --bit) // leading zero bits keep x == one
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                x[lane] = mod[lane].mul(x[lane], x[lane]);
+                const uint64_t x_times_base = mod[lane].mul(x[lane], base[lane]);
+                x[lane] = ((d[lane] >> bit) & 1) ? x_times_base : x[lane]; // branchless - exponent bits are random
+            }
+
+        std::array<bool, Lanes> is_passed{};
+        for (size_t lane = 0; lane < Lanes; ++lane)
+            is_passed[lane] = a % n[lane] == 0 || x[lane] == mod[lane].one || x[lane] == mod[lane].minus_one();
+
+        for (int i = 1; i < max_s; ++i)
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                x[lane] = mod[lane].mul(x[lane], x[lane]);
+                is_passed[lane] = is_passed[lane] || (i < s[lane] && x[lane] == mod[lane].minus_one());
+            }
+
+        return is_passed;
+    }
+} // namespace MillerRabin
+
+export constexpr bool is_prime(uint64_t n)
+{
+    const auto result = MillerRabin::trial_division(n);
+
+    if (result != MillerRabin::Result::unknown)
+        return result == MillerRabin::Result::prime;
+
+    return MillerRabin::is_strong_probable_prime(n);
+}
+
+// results[i] = is_prime(numbers[i]) - the first Miller-Rabin round (base 2), which rejects almost
+// all composites, runs batch_lanes numbers at a time; the rare survivors get the full test
+export void is_prime(std::span<const uint64_t> numbers, std::span<bool> results)
 {
-    bool is_prime = true;
+    constexpr size_t batch_lanes = 4;
+
+    std::array<uint64_t, batch_lanes> batch{};
+    std::array<size_t, batch_lanes> batch_indexes{};
+    size_t batch_size = 0;
+
+    auto flush = [&] {
+        for (size_t lane = batch_size; lane < batch_lanes; ++lane)
+            batch[lane] = batch[0]; // padding lanes repeat the first number
+
+        const auto is_passed = MillerRabin::is_strong_probable_prime(batch, MillerRabin::witnesses[0]);
+        for (size_t lane = 0; lane < batch_size; ++lane)
+            results[batch_indexes[lane]] = is_passed[lane] && MillerRabin::is_strong_probable_prime(batch[lane]);
 
-    for (auto i = 2u; i < n; ++i)
+        batch_size = 0;
+    };
+
+    for (size_t i = 0; i < numbers.size(); ++i)
     {
-        if (n % i == 0)
-            return false;
+        const auto result = MillerRabin::trial_division(numbers[i]);
+
+        if (result != MillerRabin::Result::unknown)
+        {
+            results[i] = result == MillerRabin::Result::prime;
+            continue;
+        }
+
+        batch[batch_size] = numbers[i];
+        batch_indexes[batch_size] = i;
+        if (++batch_size == batch_lanes)
+            flush();
     }
 
-    return true;
+    if (batch_size > 0)
+        flush();
 }
 
+static_assert(is_prime(2) && !is_prime(1) && is_prime(1'000'000'007) && is_prime(18'446'744'073'709'551'557u));
+static_assert(!is_prime(3'215'031'751) && !is_prime(3'825'123'056'546'413'051)); // strong pseudoprimes to small bases
+
 export struct IsPrime
 {
-    bool operator()(uint32_t n) const
+    constexpr bool operator()(uint64_t n) const
     {
         return is_prime(n);
     }
+
+    void operator()(std::span<const uint64_t> numbers, std::span<bool> results) const
+    {
+        is_prime(numbers, results);
+    }
 };
 
+//////////////////////////////////////////////////////////////////////////////
+// Segmented Sieve of Eratosthenes with 2*3*5*7 wheel (not exported)
+
+namespace Wheel
+{
+    inline constexpr uint32_t modulus = 2 * 3 * 5 * 7;
+
+    constexpr bool is_coprime(uint64_t n)
+    {
+        return n % 2 != 0 && n % 3 != 0 && n % 5 != 0 && n % 7 != 0;
+    }
+
+    // numbers in [0, 210) coprime to 210 - only multiples p * r of a sieving prime p are crossed off
+    inline constexpr auto residues = [] {
+        std::array<uint32_t, 48> residues{};
+
+        for (uint32_t r = 1, n = 0; r < modulus; ++r)
+            if (is_coprime(r))
+                residues[n++] = r;
+
+        return residues;
+    }();
+
+    // distance from residues[i] to the next residue (the last one wraps around the wheel)
+    inline constexpr auto gaps = [] {
+        std::array<uint32_t, residues.size()> gaps{};
+
+        for (size_t i = 0; i < residues.size() - 1; ++i)
+            gaps[i] = residues[i + 1] - residues[i];
+        gaps.back() = modulus + residues.front() - residues.back();
+
+        return gaps;
+    }();
+
+    // index of the smallest residue >= r for every r in [0, 210)
+    inline constexpr auto next_index = [] {
+        std::array<uint32_t, modulus> next_index{};
+
+        for (uint32_t r = 0; r < modulus; ++r)
+            next_index[r] = std::ranges::lower_bound(residues, r) - residues.begin();
+
+        return next_index;
+    }();
+
+    // pre-sieved pattern of odd numbers 2k+1 with multiples of 3, 5 & 7 removed (period 3 * 5 * 7)
+    inline constexpr auto odd_pattern = [] {
+        std::array<uint8_t, 3 * 5 * 7> pattern{};
+
+        for (uint64_t k = 0; k < pattern.size(); ++k)
+            pattern[k] = is_coprime(2 * k + 1);
+
+        return pattern;
+    }();
+} // namespace Wheel
+
+namespace Sieve
+{
+    // a segment of odd numbers fits into L1d cache (one byte per odd number)
+    inline constexpr size_t l1_segment_bytes = 32 * 1024;
+
+    constexpr uint64_t isqrt(uint64_t n)
+    {
+        uint64_t root = 0;
+
+        for (uint64_t bit = uint64_t{1} << 31; bit != 0; bit >>= 1)
+            if ((root + bit) * (root + bit) <= n)
+                root += bit;
+
+        return root;
+    }
+
+    // primes in [11, limit] - used to cross off composites in segments
+    constexpr std::vector<uint32_t> sieving_primes(uint64_t limit)
+    {
+        std::vector<uint32_t> primes;
+
+        if (limit < 11)
+            return primes;
+
+        std::vector<uint8_t> is_odd_prime(limit / 2 + 1, 1); // is_odd_prime[k] represents 2k+1
+
+        for (uint64_t k = 1; (2 * k + 1) * (2 * k + 1) <= limit; ++k)
+            if (is_odd_prime[k])
+                for (uint64_t m = (2 * k + 1) * (2 * k + 1); m <= limit; m += 2 * (2 * k + 1))
+                    is_odd_prime[m / 2] = 0;
+
+        for (uint64_t n = 11; n <= limit; n += 2)
+            if (is_odd_prime[n / 2])
+                primes.push_back(static_cast<uint32_t>(n));
+
+        return primes;
+    }
+
+    struct SievingPrime
+    {
+        uint32_t prime;
+        uint32_t wheel_index; // multiple == prime * factor, where factor % 210 == residues[wheel_index]
+        uint64_t multiple;    // next multiple to cross off
+    };
+
+    // first multiple prime * factor >= max(prime^2, start) with factor coprime to the wheel
+    constexpr SievingPrime first_multiple(uint32_t prime, uint64_t start)
+    {
+        uint64_t factor = std::max<uint64_t>(prime, (start + prime - 1) / prime);
+
+        const uint32_t wheel_index = Wheel::next_index[factor % Wheel::modulus];
+        factor += Wheel::residues[wheel_index] - factor % Wheel::modulus;
+
+        return SievingPrime{prime, wheel_index, prime * factor};
+    }
+
+    // calls on_prime(p) for every prime p in [lo, hi) in ascending order
+    // primes - sieving_primes(n) for any n >= isqrt(hi - 1) (shared by many ranges)
+    template <typename OnPrime>
+    constexpr void for_each_prime(uint64_t lo, uint64_t hi, const std::vector<uint32_t>& primes, OnPrime on_prime)
+    {
+        for (uint64_t p : {2, 3, 5, 7})
+            if (lo <= p && p < hi)
+                on_prime(p);
+
+        lo = std::max<uint64_t>(lo, 11) | 1; // only odd numbers are kept in segments
+        if (lo >= hi)
+            return;
+
+        std::vector<SievingPrime> multiples;
+        for (uint32_t p : primes)
+        {
+            if (uint64_t{p} * p >= hi)
+                break;
+            multiples.push_back(first_multiple(p, lo));
+        }
+
+        std::vector<uint8_t> segment(std::min<uint64_t>(l1_segment_bytes, (hi - lo + 1) / 2));
+
+        for (uint64_t segment_lo = lo; segment_lo < hi; segment_lo += 2 * segment.size())
+        {
+            const uint64_t segment_hi = std::min<uint64_t>(hi, segment_lo + 2 * segment.size());
+            const size_t size = (segment_hi - segment_lo + 1) / 2;
+
+            // pre-sieve multiples of 3, 5 & 7 by copying the wheel pattern
+            for (size_t i = 0, k = (segment_lo / 2) % Wheel::odd_pattern.size(); i < size; ++i)
+            {
+                segment[i] = Wheel::odd_pattern[k];
+                if (++k == Wheel::odd_pattern.size())
+                    k = 0;
+            }
+
+            for (auto& sp : multiples)
+            {
+                if (sp.multiple >= segment_hi)
+                {
+                    if (uint64_t{sp.prime} * sp.prime >= segment_hi)
+                        break; // sieving primes are sorted - no more multiples in this segment
+                    continue;
+                }
+
+                for (; sp.multiple < segment_hi; sp.wheel_index = (sp.wheel_index + 1) % Wheel::gaps.size())
+                {
+                    segment[(sp.multiple - segment_lo) / 2] = 0;
+                    sp.multiple += uint64_t{sp.prime} * Wheel::gaps[sp.wheel_index];
+                }
+            }
+
+            for (size_t i = 0; i < size; ++i)
+                if (segment[i])
+                    on_prime(segment_lo + 2 * i);
+        }
+    }
+
+    template <typename OnPrime>
+    constexpr void for_each_prime(uint64_t lo, uint64_t hi, OnPrime on_prime)
+    {
+        if (lo < hi)
+            for_each_prime(lo, hi, sieving_primes(isqrt(hi - 1)), on_prime);
+    }
+
+    // upper bound of the n-th prime: p(n) < n * (ln(n) + ln(ln(n))) for n >= 6
+    constexpr uint64_t nth_prime_upper_bound(uint64_t n)
+    {
+        if (n < 6)
+            return 15;
+
+        const uint64_t log_n = std::bit_width(n); // bit_width(n) > log2(n) > ln(n)
+        return n * (log_n + std::bit_width(log_n));
+    }
+} // namespace Sieve
+
+// all primes <= limit
+export std::vector<uint32_t> primes_up_to(uint32_t limit)
+{
+    std::vector<uint32_t> primes;
+    if (limit > 10)
+        primes.reserve(static_cast<size_t>(1.25 * limit / std::log(limit))); // pi(n) < 1.25506 * n / ln(n)
+
+    Sieve::for_each_prime(0, uint64_t{limit} + 1, [&primes](uint64_t p) { primes.push_back(static_cast<uint32_t>(p)); });
+
+    return primes;
+}
+
 export template <uint32_t N>
 constexpr std::array<uint32_t, N> get_primes()
 {
     std::array<uint32_t, N> primes{};
 
     uint32_t n = 0;
-    for (uint32_t i = 2; n < N; ++i)
-        if (is_prime(i))
-        {
-            primes[n++] = i;
-        }
+    Sieve::for_each_prime(0, Sieve::nth_prime_upper_bound(N) + 1, [&](uint64_t p) {
+        if (n < N)
+            primes[n++] = static_cast<uint32_t>(p);
+    });
 
     return primes;
 }
 
 export template <uint32_t N>
-constexpr auto first_primes = get_primes<10>();
+constexpr auto first_primes = get_primes<N>();
+
+export const std::array first_100_primes = get_primes<100>();
+
+//////////////////////////////////////////////////////////////////////////////
+// Compressed prime tables - mod 30 wheel bitmap built at compile time
+
+// one byte per 30 numbers: bit k of byte i is set if 30 * i + offsets[k] is prime
+// (2, 3 & 5 are the only primes not coprime to 30); ~1/9 of the size of std::array<uint32_t, pi(Limit)>
+// note: tables above ~500'000 exceed gcc's default constexpr budget (-fconstexpr-ops-limit, MSVC: /constexpr:steps)
+export template <uint32_t Limit>
+class PrimeBitmap
+{
+public:
+    static constexpr std::array<uint32_t, 8> offsets = {1, 7, 11, 13, 17, 19, 23, 29};
+
+private:
+    static constexpr size_t byte_count = Limit / 30 + 1;
+    static constexpr size_t block_bytes = 32; // rank directory sample - 960 numbers
+
+    static constexpr std::array<uint32_t, 3> wheel_primes = {2, 3, 5};
+
+    static constexpr auto bit_index = [] {
+        std::array<uint8_t, 30> bit_index{};
+        bit_index.fill(0xFF);
+        for (uint8_t k = 0; k < offsets.size(); ++k)
+            bit_index[offsets[k]] = k;
+        return bit_index;
+    }();
 
-export const std::array first_100_primes = get_primes<100>();
\ No newline at end of file
+    std::array<uint8_t, byte_count> bits_{};
+    std::array<uint32_t, (byte_count + block_bytes - 1) / block_bytes> block_rank_{}; // primes > 5 before each block
+    uint32_t count_ = 0;
+
+public:
+    constexpr PrimeBitmap()
+    {
+        // sieve directly on the wheel - only 8 of every 30 numbers are ever touched,
+        // which keeps constant evaluation cheap
+        bits_.fill(0xFF);
+        bits_[0] &= ~1u; // 1 is not prime
+        for (uint32_t i = byte_count * 30 - 30; i < byte_count * 30; ++i)
+            if (i > Limit && bit_index[i % 30] != 0xFF)
+                bits_.back() &= ~(1u << bit_index[i % 30]);
+
+        for (uint64_t p = 7; p * p <= Limit; p += 2)
+        {
+            if (!::is_prime(p)) // the Miller-Rabin test - not the member is_prime() of the bitmap being built
+                continue;
+
+            // multiples p * (30 * j + offsets[k]) lie in byte p * j + p * offsets[k] / 30 at a fixed bit
+            std::array<uint64_t, offsets.size()> byte_offsets{};
+            std::array<uint8_t, offsets.size()> masks{};
+            for (size_t k = 0; k < offsets.size(); ++k)
+            {
+                byte_offsets[k] = p * offsets[k] / 30;
+                masks[k] = static_cast<uint8_t>(~(1u << bit_index[p * offsets[k] % 30]));
+            }
+
+            for (uint64_t j = p / 30; p * 30 * j <= Limit; ++j)
+                for (size_t k = 0; k < offsets.size(); ++k)
+                {
+                    const uint64_t m = 30 * j + offsets[k];
+                    if (m >= p && p * m <= Limit)
+                        bits_[p * j + byte_offsets[k]] &= masks[k];
+                }
+        }
+
+        uint32_t rank = 0;
+        for (size_t i = 0; i < byte_count; ++i)
+        {
+            if (i % block_bytes == 0)
+                block_rank_[i / block_bytes] = rank;
+            rank += std::popcount(bits_[i]);
+        }
+
+        count_ = rank + std::ranges::count_if(wheel_primes, [](uint32_t p) { return p <= Limit; });
+    }
+
+    static constexpr uint32_t limit()
+    {
+        return Limit;
+    }
+
+    // number of primes <= Limit
+    constexpr uint32_t count() const
+    {
+        return count_;
+    }
+
+    // O(1) lookup - n <= Limit
+    constexpr bool is_prime(uint32_t n) const
+    {
+        if (n < 7)
+            return n == 2 || n == 3 || n == 5;
+
+        const uint8_t k = bit_index[n % 30];
+        return k != 0xFF && (bits_[n / 30] >> k) & 1;
+    }
+
+    // number of primes <= n (pi(n)) - n <= Limit
+    constexpr uint32_t rank(uint32_t n) const
+    {
+        if (n < 7)
+            return static_cast<uint32_t>(std::ranges::count_if(wheel_primes, [n](uint32_t p) { return p <= n; }));
+
+        const size_t byte = n / 30;
+        uint32_t rank = wheel_primes.size() + block_rank_[byte / block_bytes];
+
+        for (size_t i = byte / block_bytes * block_bytes; i < byte; ++i)
+            rank += std::popcount(bits_[i]);
+
+        const uint32_t bits_up_to_n = static_cast<uint32_t>(std::ranges::upper_bound(offsets, n % 30) - offsets.begin());
+        return rank + std::popcount(static_cast<uint8_t>(bits_[byte] & ((1u << bits_up_to_n) - 1)));
+    }
+
+    // k-th prime (select(0) == 2) - k < count()
+    constexpr uint32_t select(uint32_t k) const
+    {
+        if (k < wheel_primes.size())
+            return wheel_primes[k];
+        k -= wheel_primes.size();
+
+        const size_t block = std::ranges::upper_bound(block_rank_, k) - block_rank_.begin() - 1;
+        k -= block_rank_[block];
+
+        for (size_t i = block * block_bytes;; ++i)
+        {
+            const uint32_t byte_rank = std::popcount(bits_[i]);
+            if (k < byte_rank)
+            {
+                uint8_t byte = bits_[i];
+                for (; k > 0; --k)
+                    byte &= byte - 1; // clear lowest set bit
+
+                return static_cast<uint32_t>(30 * i + offsets[std::countr_zero(byte)]);
+            }
+            k -= byte_rank;
+        }
+    }
+};
+
+export template <uint32_t Limit>
+constexpr PrimeBitmap<Limit> prime_bitmap{};
+
+static_assert(prime_bitmap<1'000>.count() == 168 && prime_bitmap<1'000>.select(99) == 541 && prime_bitmap<1'000>.rank(541) == 100);
+
+//////////////////////////////////////////////////////////////////////////////
+// Parallel mode - [lo, hi) is split into chunks sieved by a pool of threads
+
+namespace Parallel
+{
+    // numbers per task - 64 L1-sized segments
+    inline constexpr uint64_t chunk_size = 64 * 2 * Sieve::l1_segment_bytes;
+
+    inline unsigned default_thread_count()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+} // namespace Parallel
+
+// number of primes in [lo, hi) (num_threads == 0 - one thread)
+export uint64_t count_primes(uint64_t lo, uint64_t hi, unsigned num_threads = Parallel::default_thread_count())
+{
+    if (lo >= hi)
+        return 0;
+
+    num_threads = std::max(num_threads, 1u);
+
+    const auto primes = Sieve::sieving_primes(Sieve::isqrt(hi - 1));
+    const uint64_t chunk_count = (hi - lo - 1) / Parallel::chunk_size + 1;
+
+    std::atomic<uint64_t> next_chunk{0};
+    std::atomic<uint64_t> total_count{0};
+
+    auto worker = [&] {
+        uint64_t count = 0;
+
+        for (uint64_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+        {
+            const uint64_t chunk_lo = lo + chunk * Parallel::chunk_size;
+            const uint64_t chunk_hi = std::min(hi, chunk_lo + Parallel::chunk_size);
+
+            Sieve::for_each_prime(chunk_lo, chunk_hi, primes, [&count](uint64_t) { ++count; });
+        }
+
+        total_count += count;
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned i = 0; i < std::min<uint64_t>(num_threads, chunk_count); ++i)
+            pool.emplace_back(worker);
+    } // join
+
+    return total_count;
+}
+
+// calls on_prime(p) for every prime p in [lo, hi) in ascending order on the calling thread,
+// while the pool sieves a bounded window of chunks ahead (num_threads == 0 - one thread)
+export template <typename OnPrime>
+void for_each_prime_parallel(uint64_t lo, uint64_t hi, OnPrime on_prime, unsigned num_threads = Parallel::default_thread_count())
+{
+    if (lo >= hi)
+        return;
+
+    num_threads = std::max(num_threads, 1u);
+
+    const auto primes = Sieve::sieving_primes(Sieve::isqrt(hi - 1));
+    const uint64_t chunk_count = (hi - lo - 1) / Parallel::chunk_size + 1;
+    const uint64_t window = 2 * uint64_t{num_threads};
+
+    struct Slot
+    {
+        std::vector<uint64_t> primes;
+        bool is_ready = false;
+    };
+
+    std::vector<Slot> slots(window);
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t next_chunk = 0;
+    uint64_t consumed = 0;
+    bool is_cancelled = false;
+
+    auto worker = [&] {
+        while (true)
+        {
+            uint64_t chunk;
+            {
+                std::unique_lock lk{mtx};
+                cv.wait(lk, [&] { return is_cancelled || next_chunk == chunk_count || next_chunk < consumed + window; });
+                if (is_cancelled || next_chunk == chunk_count)
+                    return;
+                chunk = next_chunk++;
+            }
+
+            const uint64_t chunk_lo = lo + chunk * Parallel::chunk_size;
+            const uint64_t chunk_hi = std::min(hi, chunk_lo + Parallel::chunk_size);
+
+            std::vector<uint64_t> found;
+            Sieve::for_each_prime(chunk_lo, chunk_hi, primes, [&found](uint64_t p) { found.push_back(p); });
+
+            {
+                std::lock_guard lk{mtx};
+                slots[chunk % window] = Slot{std::move(found), true};
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::jthread> pool;
+    for (unsigned i = 0; i < std::min<uint64_t>(num_threads, chunk_count); ++i)
+        pool.emplace_back(worker);
+
+    try
+    {
+        while (consumed < chunk_count)
+        {
+            std::vector<uint64_t> found;
+            {
+                std::unique_lock lk{mtx};
+                Slot& slot = slots[consumed % window];
+                cv.wait(lk, [&] { return slot.is_ready; });
+                found = std::move(slot.primes);
+                slot.is_ready = false;
+                ++consumed;
+            }
+            cv.notify_all();
+
+            for (uint64_t p : found)
+                on_prime(p);
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard lk{mtx};
+            is_cancelled = true;
+        }
+        cv.notify_all();
+        throw;
+    }
+}
+
+// all primes in [lo, hi) (num_threads == 0 - one thread)
+export std::vector<uint64_t> primes_in_range(uint64_t lo, uint64_t hi, unsigned num_threads = Parallel::default_thread_count())
+{
+    std::vector<uint64_t> primes;
+    for_each_prime_parallel(lo, hi, [&primes](uint64_t p) { primes.push_back(p); }, num_threads);
+
+    return primes;
+}
\ No newline at end of file